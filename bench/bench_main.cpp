@@ -0,0 +1,387 @@
+// bench_main.cpp
+// jpeg_info_bench：在合成语料上测量索引、各 parse_* 与格式化的吞吐
+#include "entropy_scan.h"
+#include "format.h"
+#include "format_json.h"
+#include "jpeg_synth.h"
+#include "jpeginfo.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 非连续数据源：每次 read_at 都拷贝，模拟文件读取路径
+class CopySource : public ByteSource {
+public:
+  explicit CopySource(const std::vector<uint8_t> &d) : d_(d) {}
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) override {
+    if (off >= d_.size())
+      return 0;
+    n = std::min<size_t>(n, d_.size() - (size_t)off);
+    std::memcpy(dst, d_.data() + off, n);
+    io_.read_calls++;
+    io_.bytes_read += n;
+    return n;
+  }
+  bool size(uint64_t &out) override {
+    out = d_.size();
+    return true;
+  }
+
+private:
+  const std::vector<uint8_t> &d_;
+};
+
+struct Scenario {
+  const char *name;
+  SynthOptions synth;
+  size_t files; // 语料中的文件数（各自不同 seed）
+};
+
+std::vector<Scenario> make_scenarios() {
+  std::vector<Scenario> v;
+  {
+    SynthOptions o;
+    o.scan_bytes = 4 * 1024;
+    v.push_back({"small", o, 256});
+  }
+  {
+    SynthOptions o;
+    o.exif_entries = 60;
+    o.exif_gps = true;
+    o.xmp_bytes = 4096;
+    o.icc_bytes = 3144;
+    o.com_bytes = 64;
+    o.adobe = true;
+    o.scan_bytes = 2 * 1024 * 1024;
+    o.stuffing_ratio = 1.0 / 64;
+    o.restart_interval = 4096;
+    v.push_back({"camera", o, 16});
+  }
+  {
+    SynthOptions o;
+    o.app_segments = 200;
+    o.scan_bytes = 4 * 1024;
+    v.push_back({"many_app", o, 64});
+  }
+  {
+    SynthOptions o;
+    o.icc_bytes = 1024 * 1024;
+    o.scan_bytes = 4 * 1024;
+    v.push_back({"icc_multi", o, 8});
+  }
+  {
+    SynthOptions o;
+    o.xmp_bytes = 20 * 1024;
+    o.xmp_padding = 40 * 1024;
+    o.scan_bytes = 4 * 1024;
+    v.push_back({"xmp_large", o, 32});
+  }
+  {
+    SynthOptions o;
+    o.exif_entries = 1000;
+    o.exif_gps = true;
+    o.exif_big_endian = true;
+    o.scan_bytes = 4 * 1024;
+    v.push_back({"exif_big", o, 32});
+  }
+  {
+    SynthOptions o;
+    o.scan_bytes = 32 * 1024 * 1024;
+    o.stuffing_ratio = 0.25;
+    o.restart_interval = 8192;
+    v.push_back({"scan_stuffed", o, 2});
+  }
+  return v;
+}
+
+struct Config {
+  double min_time = 0.3; // 每项至少运行的秒数
+  const char *filter = nullptr;
+  const char *corpus_dir = nullptr;
+};
+
+volatile size_t g_sink = 0;
+
+// 重复运行 fn（每次处理整个语料）直到超过 min_time，输出 MB/s 与 files/s
+void run(const Config &cfg, const char *scenario, const char *name,
+         size_t files, uint64_t bytes, const std::function<size_t()> &fn) {
+  if (cfg.filter && !std::strstr(name, cfg.filter) &&
+      !std::strstr(scenario, cfg.filter))
+    return;
+  if (files == 0)
+    return;
+  using clock = std::chrono::steady_clock;
+  g_sink = g_sink + fn(); // 预热
+  size_t iters = 0;
+  auto t0 = clock::now();
+  double elapsed = 0;
+  do {
+    g_sink = g_sink + fn();
+    iters++;
+    elapsed = std::chrono::duration<double>(clock::now() - t0).count();
+  } while (elapsed < cfg.min_time);
+
+  double mbps = (double)bytes * iters / elapsed / (1024.0 * 1024.0);
+  double fps = (double)files * iters / elapsed;
+  std::printf("%-13s %-16s %12.1f %14.0f %12.0f\n", scenario, name, mbps, fps,
+              1e9 / fps);
+}
+
+std::vector<ByteSpan> payloads_of(const std::vector<uint8_t> &file,
+                                  const JpegIndexResult &idx,
+                                  const std::function<bool(const SegmentIndex &)> &pick) {
+  std::vector<ByteSpan> out;
+  for (const auto &s : idx.segments)
+    if (pick(s) && s.payload_offset + s.payload_len <= file.size())
+      out.emplace_back(file.data() + s.payload_offset, s.payload_len);
+  return out;
+}
+
+void bench_scenario(const Config &cfg, const Scenario &sc) {
+  std::vector<std::vector<uint8_t>> corpus;
+  uint64_t total = 0;
+  for (size_t i = 0; i < sc.files; i++) {
+    SynthOptions o = sc.synth;
+    o.seed = (uint32_t)(i + 1);
+    corpus.push_back(synthesize_jpeg(o));
+    total += corpus.back().size();
+  }
+
+  if (cfg.corpus_dir) {
+    for (size_t i = 0; i < corpus.size(); i++) {
+      std::string path = std::string(cfg.corpus_dir) + "/" + sc.name + "_" +
+                         std::to_string(i) + ".jpg";
+      std::ofstream f(path, std::ios::binary);
+      f.write((const char *)corpus[i].data(), (std::streamsize)corpus[i].size());
+    }
+  }
+
+  IndexOptions full;
+  IndexOptions meta;
+  meta.stop_at_sos = true;
+
+  run(cfg, sc.name, "index_full", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &f : corpus)
+      n += build_jpeg_index(f.data(), f.size(), full).segments.size();
+    return n;
+  });
+  run(cfg, sc.name, "index_meta", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &f : corpus)
+      n += build_jpeg_index(f.data(), f.size(), meta).segments.size();
+    return n;
+  });
+
+  // 预先建立索引并切出各类 payload，下面只测解析函数本身
+  std::vector<ByteSpan> jfif, sof, exif, xmp, icc, adobe, com;
+  std::vector<uint16_t> sof_markers;
+  std::vector<std::vector<ByteSpan>> icc_per_file;
+  for (const auto &f : corpus) {
+    JpegIndexResult idx = build_jpeg_index(f.data(), f.size(), meta);
+    auto add = [](std::vector<ByteSpan> &dst, std::vector<ByteSpan> src) {
+      dst.insert(dst.end(), src.begin(), src.end());
+    };
+    add(jfif, payloads_of(f, idx, [](const SegmentIndex &s) {
+          return s.app_subtype == "JFIF";
+        }));
+    for (const auto &s : idx.segments)
+      if (is_sof_marker(s.marker)) {
+        sof.emplace_back(f.data() + s.payload_offset, s.payload_len);
+        sof_markers.push_back(s.marker);
+      }
+    add(exif, payloads_of(f, idx, [](const SegmentIndex &s) {
+          return s.app_subtype == "EXIF";
+        }));
+    add(xmp, payloads_of(f, idx, [](const SegmentIndex &s) {
+          return s.app_subtype == "XMP";
+        }));
+    icc_per_file.push_back(payloads_of(f, idx, [](const SegmentIndex &s) {
+      return s.app_subtype == "ICC";
+    }));
+    add(icc, icc_per_file.back());
+    add(adobe, payloads_of(f, idx, [](const SegmentIndex &s) {
+          return s.app_subtype == "Adobe";
+        }));
+    add(com, payloads_of(f, idx, [](const SegmentIndex &s) {
+          return s.marker == 0xFFFE;
+        }));
+  }
+  auto bytes_of = [](const std::vector<ByteSpan> &v) {
+    uint64_t n = 0;
+    for (const auto &s : v)
+      n += s.size();
+    return n;
+  };
+
+  run(cfg, sc.name, "parse_jfif", jfif.size(), bytes_of(jfif), [&] {
+    size_t n = 0;
+    for (const auto &p : jfif)
+      n += parse_jfif_from_app0_payload(p).has_value();
+    return n;
+  });
+  run(cfg, sc.name, "parse_sof", sof.size(), bytes_of(sof), [&] {
+    size_t n = 0;
+    for (size_t i = 0; i < sof.size(); i++)
+      n += parse_sof_payload(sof_markers[i], sof[i]).has_value();
+    return n;
+  });
+  run(cfg, sc.name, "parse_exif", exif.size(), bytes_of(exif), [&] {
+    size_t n = 0;
+    for (const auto &p : exif)
+      n += parse_exif_from_app1_payload(p).has_value();
+    return n;
+  });
+  // 批量建立日期/机型索引时的典型请求
+  ExifTagFilter date_camera;
+  date_camera.add("Make");
+  date_camera.add("Model");
+  date_camera.add("DateTimeOriginal");
+  run(cfg, sc.name, "parse_exif_tags", exif.size(), bytes_of(exif), [&] {
+    size_t n = 0;
+    for (const auto &p : exif)
+      n += parse_exif_from_app1_payload(p, &date_camera).has_value();
+    return n;
+  });
+  run(cfg, sc.name, "parse_xmp", xmp.size(), bytes_of(xmp), [&] {
+    size_t n = 0;
+    for (const auto &p : xmp)
+      n += parse_xmp_from_app1_payload(p, true, 2048).has_value();
+    return n;
+  });
+  size_t icc_files = 0;
+  for (const auto &v : icc_per_file)
+    icc_files += !v.empty();
+  run(cfg, sc.name, "parse_icc", icc_files, bytes_of(icc), [&] {
+    size_t n = 0;
+    for (const auto &segs : icc_per_file) {
+      if (segs.empty())
+        continue;
+      IccCollector collector;
+      for (const auto &p : segs)
+        collector.add(p);
+      n += collector.finish().has_value();
+    }
+    return n;
+  });
+  run(cfg, sc.name, "parse_adobe", adobe.size(), bytes_of(adobe), [&] {
+    size_t n = 0;
+    for (const auto &p : adobe)
+      n += parse_adobe_app14_payload(p).has_value();
+    return n;
+  });
+  run(cfg, sc.name, "parse_com", com.size(), bytes_of(com), [&] {
+    size_t n = 0;
+    for (const auto &p : com)
+      n += parse_com_payload_preview(p, 256).len;
+    return n;
+  });
+
+  // 格式化：先解析出完整结果，再只测 print_* 的开销
+  std::vector<JpegInfo> infos(corpus.size());
+  AnalyzeOptions aopt;
+  for (size_t i = 0; i < corpus.size(); i++)
+    analyze_jpeg_buffer(corpus[i].data(), corpus[i].size(), aopt, infos[i]);
+  I18n i18n;
+  i18n.lang = Lang::EN;
+  std::string text;
+  run(cfg, sc.name, "format_all", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &info : infos) {
+      text.clear(); // 复用缓冲，与命令行每个文件一个输出块一致
+      print_segments(text, info.index.segments, i18n);
+      for (const auto &x : info.jfif)
+        print_jfif_info(text, x, i18n);
+      for (const auto &x : info.sof)
+        print_sof_info(text, x, i18n);
+      for (const auto &x : info.exif)
+        print_exif_info(text, x, i18n);
+      for (const auto &x : info.xmp)
+        print_xmp_info(text, x, i18n);
+      if (info.icc.has_value())
+        print_icc_info(text, *info.icc, i18n);
+      for (const auto &x : info.adobe)
+        print_adobe_info(text, x, i18n);
+      for (const auto &x : info.com)
+        print_com_info(text, x, i18n);
+      n += text.size();
+    }
+    return n;
+  });
+
+  std::string json;
+  run(cfg, sc.name, "format_json", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &info : infos) {
+      json.clear(); // 复用缓冲，与命令行每个文件一个输出块一致
+      JsonWriter w(json);
+      write_jpeg_json(w, "bench.jpg", info, JsonSections());
+      n += json.size();
+    }
+    return n;
+  });
+
+  run(cfg, sc.name, "analyze_buffer", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &f : corpus) {
+      JpegInfo info;
+      n += analyze_jpeg_buffer(f.data(), f.size(), aopt, info);
+    }
+    return n;
+  });
+
+  run(cfg, sc.name, "probe_buffer", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &f : corpus) {
+      JpegProbe p;
+      n += probe_jpeg_buffer(f.data(), f.size(), p);
+    }
+    return n;
+  });
+  run(cfg, sc.name, "probe_reads", corpus.size(), total, [&] {
+    size_t n = 0;
+    for (const auto &f : corpus) {
+      CopySource src(f);
+      JpegProbe p;
+      n += probe_jpeg(src, p);
+    }
+    return n;
+  });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Config cfg;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--min-time=", 0) == 0) {
+      cfg.min_time = std::atof(arg.c_str() + 11);
+    } else if (arg.rfind("--filter=", 0) == 0) {
+      cfg.filter = argv[i] + 9;
+    } else if (arg.rfind("--write-corpus=", 0) == 0) {
+      cfg.corpus_dir = argv[i] + 15;
+    } else {
+      std::printf("用法: %s [--min-time=秒] [--filter=子串] "
+                  "[--write-corpus=目录]\n",
+                  argv[0]);
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+
+  std::printf("entropy scan: %s\n", entropy_scan_impl_name());
+  std::printf("%-13s %-16s %12s %14s %12s\n", "scenario", "benchmark", "MB/s",
+              "files/s", "ns/file");
+  for (const auto &sc : make_scenarios())
+    bench_scenario(cfg, sc);
+  return 0;
+}
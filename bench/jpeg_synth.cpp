@@ -0,0 +1,303 @@
+// jpeg_synth.cpp
+#include "jpeg_synth.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+
+struct Writer {
+  std::vector<uint8_t> &out;
+  bool big = true;
+
+  void u8(uint8_t v) { out.push_back(v); }
+  void u16(uint16_t v) {
+    if (big) {
+      u8((uint8_t)(v >> 8));
+      u8((uint8_t)v);
+    } else {
+      u8((uint8_t)v);
+      u8((uint8_t)(v >> 8));
+    }
+  }
+  void u32(uint32_t v) {
+    if (big) {
+      u16((uint16_t)(v >> 16));
+      u16((uint16_t)v);
+    } else {
+      u16((uint16_t)v);
+      u16((uint16_t)(v >> 16));
+    }
+  }
+  void bytes(const void *p, size_t n) {
+    const uint8_t *b = (const uint8_t *)p;
+    out.insert(out.end(), b, b + n);
+  }
+  void put_u32_at(size_t pos, uint32_t v) {
+    std::vector<uint8_t> tmp;
+    Writer w{tmp, big};
+    w.u32(v);
+    std::memcpy(out.data() + pos, tmp.data(), 4);
+  }
+};
+
+void segment(std::vector<uint8_t> &out, uint8_t marker,
+             const std::vector<uint8_t> &payload) {
+  size_t len = std::min<size_t>(payload.size(), 65533);
+  out.push_back(0xFF);
+  out.push_back(marker);
+  out.push_back((uint8_t)((len + 2) >> 8));
+  out.push_back((uint8_t)(len + 2));
+  out.insert(out.end(), payload.begin(), payload.begin() + len);
+}
+
+struct IfdEntry {
+  uint16_t tag;
+  uint16_t type;
+  uint32_t count;
+  std::vector<uint8_t> data; // 已按字节序编码
+};
+
+// 写一个 IFD 到 tiff（偏移相对 TIFF 头），返回 IFD 起始偏移
+size_t write_ifd(Writer &w, std::vector<IfdEntry> entries) {
+  std::sort(entries.begin(), entries.end(),
+            [](const IfdEntry &a, const IfdEntry &b) { return a.tag < b.tag; });
+  size_t start = w.out.size();
+  size_t data_off = start + 2 + entries.size() * 12 + 4;
+  w.u16((uint16_t)entries.size());
+  std::vector<uint8_t> data;
+  for (const auto &e : entries) {
+    w.u16(e.tag);
+    w.u16(e.type);
+    w.u32(e.count);
+    if (e.data.size() <= 4) {
+      std::vector<uint8_t> inl = e.data;
+      inl.resize(4, 0);
+      w.bytes(inl.data(), 4);
+    } else {
+      w.u32((uint32_t)(data_off + data.size()));
+      data.insert(data.end(), e.data.begin(), e.data.end());
+      if (data.size() & 1)
+        data.push_back(0);
+    }
+  }
+  w.u32(0); // next IFD
+  w.bytes(data.data(), data.size());
+  return start;
+}
+
+std::vector<uint8_t> enc16(bool big, std::initializer_list<uint16_t> vals) {
+  std::vector<uint8_t> v;
+  Writer w{v, big};
+  for (auto x : vals)
+    w.u16(x);
+  return v;
+}
+std::vector<uint8_t> enc32(bool big, std::initializer_list<uint32_t> vals) {
+  std::vector<uint8_t> v;
+  Writer w{v, big};
+  for (auto x : vals)
+    w.u32(x);
+  return v;
+}
+std::vector<uint8_t> ascii(const std::string &s) {
+  std::vector<uint8_t> v(s.begin(), s.end());
+  v.push_back(0);
+  return v;
+}
+
+std::vector<uint8_t> make_exif(const SynthOptions &opt, std::mt19937 &rng) {
+  bool big = opt.exif_big_endian;
+  std::vector<uint8_t> tiff;
+  Writer w{tiff, big};
+  w.bytes(big ? "MM" : "II", 2);
+  w.u16(0x2A);
+  w.u32(8);
+
+  // IFD0：常见相机标签 + 指向 EXIF/GPS 子 IFD 的指针（稍后回填）
+  std::vector<IfdEntry> ifd0 = {
+      {0x010F, 2, 6, ascii("Canon")},
+      {0x0110, 2, 0, ascii("Synthetic Camera")},
+      {0x0112, 3, 1, enc16(big, {1})},
+      {0x011A, 5, 1, enc32(big, {72, 1})},
+      {0x011B, 5, 1, enc32(big, {72, 1})},
+      {0x0128, 3, 1, enc16(big, {2})},
+      {0x0132, 2, 20, ascii("2024:01:02 03:04:05")},
+      {0x8769, 4, 1, enc32(big, {0})},
+  };
+  ifd0[1].count = (uint32_t)ifd0[1].data.size();
+  if (opt.exif_gps)
+    ifd0.push_back({0x8825, 4, 1, enc32(big, {0})});
+  write_ifd(w, ifd0);
+
+  // EXIF IFD：已知标签之后用私有标签号补足条目数，类型轮换
+  std::vector<IfdEntry> exif = {
+      {0x829A, 5, 1, enc32(big, {1, 250})},
+      {0x829D, 5, 1, enc32(big, {28, 10})},
+      {0x8827, 3, 1, enc16(big, {400})},
+      {0x9003, 2, 20, ascii("2024:01:02 03:04:05")},
+      {0x9209, 3, 1, enc16(big, {0x19})},
+  };
+  for (size_t i = exif.size(); i < opt.exif_entries; i++) {
+    uint16_t tag = (uint16_t)(0xC000 + i);
+    switch (i % 5) {
+    case 0:
+      exif.push_back({tag, 3, 1, enc16(big, {(uint16_t)rng()})});
+      break;
+    case 1:
+      exif.push_back({tag, 4, 1, enc32(big, {(uint32_t)rng()})});
+      break;
+    case 2:
+      exif.push_back({tag, 5, 1, enc32(big, {(uint32_t)(rng() % 1000), 100})});
+      break;
+    case 3:
+      exif.push_back({tag, 2, 0, ascii("value " + std::to_string(i))});
+      exif.back().count = (uint32_t)exif.back().data.size();
+      break;
+    default: {
+      std::vector<uint8_t> blob(64);
+      for (auto &b : blob)
+        b = (uint8_t)rng();
+      exif.push_back({tag, 7, (uint32_t)blob.size(), blob});
+      break;
+    }
+    }
+  }
+  size_t exif_off = write_ifd(w, exif);
+  w.put_u32_at(8 + 2 + 7 * 12 + 8, (uint32_t)exif_off); // ifd0[7] 的值字段
+
+  if (opt.exif_gps) {
+    std::vector<IfdEntry> gps = {
+        {0x0000, 1, 4, {2, 3, 0, 0}},
+        {0x0001, 2, 2, ascii("N")},
+        {0x0002, 5, 3, enc32(big, {37, 1, 46, 1, 3000, 100})},
+        {0x0003, 2, 2, ascii("W")},
+        {0x0004, 5, 3, enc32(big, {122, 1, 25, 1, 1000, 100})},
+        {0x0006, 5, 1, enc32(big, {123, 10})},
+    };
+    size_t gps_off = write_ifd(w, gps);
+    w.put_u32_at(8 + 2 + 8 * 12 + 8, (uint32_t)gps_off); // ifd0[8]
+  }
+
+  // 一次分配后按显式长度拷贝；从定长初始化列表插入区间会触发 GCC 的
+  // -Warray-bounds 误报
+  std::vector<uint8_t> payload(6 + tiff.size());
+  std::memcpy(payload.data(), "Exif\0\0", 6);
+  std::memcpy(payload.data() + 6, tiff.data(), tiff.size());
+  return payload;
+}
+
+std::vector<uint8_t> make_xmp(const SynthOptions &opt) {
+  static const char *sig = "http://ns.adobe.com/xap/1.0/";
+  std::string xml =
+      "<?xpacket begin=\"\xEF\xBB\xBF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>"
+      "<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"><rdf:RDF "
+      "xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\">"
+      "<rdf:Description rdf:about=\"\" xmlns:xmp=\"http://ns.adobe.com/xap/1.0/\" "
+      "xmlns:aux=\"http://ns.adobe.com/exif/1.0/aux/\" "
+      "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmp:Rating=\"4\">"
+      "<xmp:CreateDate>2024-01-02T03:04:05</xmp:CreateDate>"
+      "<xmp:ModifyDate>2024-02-02T03:04:05</xmp:ModifyDate>"
+      "<aux:Lens>RF24-70mm F2.8 L IS USM</aux:Lens>"
+      "<aux:LensModel>RF24-70mm F2.8 L IS USM</aux:LensModel><dc:subject><rdf:Bag>";
+  const std::string tail =
+      "</rdf:Bag></dc:subject></rdf:Description></rdf:RDF></x:xmpmeta>";
+  for (size_t i = 0; xml.size() + tail.size() < opt.xmp_bytes; i++)
+    xml += "<rdf:li>keyword" + std::to_string(i) + "</rdf:li>\n";
+  xml += tail;
+  xml.append(opt.xmp_padding, ' ');
+  xml += "<?xpacket end=\"w\"?>";
+
+  const size_t sig_len = std::strlen(sig) + 1; // 含结尾 '\0'
+  std::vector<uint8_t> payload(sig_len + xml.size());
+  std::memcpy(payload.data(), sig, sig_len);
+  std::memcpy(payload.data() + sig_len, xml.data(), xml.size());
+  return payload;
+}
+
+void write_icc(std::vector<uint8_t> &out, const SynthOptions &opt,
+               std::mt19937 &rng) {
+  static const char sig[] = "ICC_PROFILE";
+  size_t chunk = std::max<size_t>(1, std::min<size_t>(opt.icc_chunk_bytes, 65519));
+  size_t total = (opt.icc_bytes + chunk - 1) / chunk;
+  total = std::min<size_t>(total, 255);
+  size_t remaining = opt.icc_bytes;
+  for (size_t i = 0; i < total; i++) {
+    size_t n = std::min(chunk, remaining);
+    remaining -= n;
+    std::vector<uint8_t> p(sig, sig + sizeof(sig)); // 含结尾 '\0'
+    p.push_back((uint8_t)(i + 1));
+    p.push_back((uint8_t)total);
+    for (size_t k = 0; k < n; k++)
+      p.push_back((uint8_t)rng());
+    segment(out, 0xE2, p);
+  }
+}
+
+void write_scan(std::vector<uint8_t> &out, const SynthOptions &opt,
+                std::mt19937 &rng) {
+  std::bernoulli_distribution stuff(opt.stuffing_ratio);
+  size_t start = out.size();
+  out.reserve(start + opt.scan_bytes + opt.scan_bytes / 8 + 16);
+  size_t since_rst = 0;
+  unsigned rst = 0;
+  while (out.size() - start < opt.scan_bytes) {
+    if (stuff(rng)) {
+      out.push_back(0xFF);
+      out.push_back(0x00);
+    } else {
+      uint8_t b = (uint8_t)rng();
+      out.push_back(b == 0xFF ? 0xFE : b);
+    }
+    if (opt.restart_interval && ++since_rst >= opt.restart_interval) {
+      out.push_back(0xFF);
+      out.push_back((uint8_t)(0xD0 + (rst++ & 7)));
+      since_rst = 0;
+    }
+  }
+}
+
+} // namespace
+
+std::vector<uint8_t> synthesize_jpeg(const SynthOptions &opt) {
+  std::mt19937 rng(opt.seed);
+  std::vector<uint8_t> out = {0xFF, 0xD8};
+
+  if (opt.jfif)
+    segment(out, 0xE0, {'J', 'F', 'I', 'F', 0, 1, 2, 1, 0, 72, 0, 72, 0, 0});
+  if (opt.exif_entries > 0)
+    segment(out, 0xE1, make_exif(opt, rng));
+  if (opt.xmp_bytes > 0)
+    segment(out, 0xE1, make_xmp(opt));
+  if (opt.icc_bytes > 0)
+    write_icc(out, opt, rng);
+  for (size_t i = 0; i < opt.app_segments; i++) {
+    std::vector<uint8_t> p(opt.app_segment_bytes);
+    for (auto &b : p)
+      b = (uint8_t)rng();
+    segment(out, (uint8_t)(0xE3 + i % 10), p); // APP3..APP12
+  }
+  if (opt.adobe)
+    segment(out, 0xEE, {'A', 'd', 'o', 'b', 'e', 0, 100, 0, 0, 0, 0, 1});
+  if (opt.com_bytes > 0) {
+    std::vector<uint8_t> p(opt.com_bytes);
+    for (size_t i = 0; i < p.size(); i++)
+      p[i] = (uint8_t)('a' + i % 26);
+    segment(out, 0xFE, p);
+  }
+
+  segment(out, 0xDB, std::vector<uint8_t>(65, 1));
+  segment(out, 0xC0,
+          {8, (uint8_t)(opt.height >> 8), (uint8_t)opt.height,
+           (uint8_t)(opt.width >> 8), (uint8_t)opt.width, 3, 1, 0x22, 0, 2,
+           0x11, 1, 3, 0x11, 1});
+  segment(out, 0xC4, std::vector<uint8_t>(29, 0));
+  if (opt.restart_interval)
+    segment(out, 0xDD, {0, 64});
+  segment(out, 0xDA, {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 0x3F, 0});
+  write_scan(out, opt, rng);
+  out.push_back(0xFF);
+  out.push_back(0xD9);
+  return out;
+}
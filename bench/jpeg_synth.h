@@ -0,0 +1,31 @@
+// jpeg_synth.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 合成 JPEG 容器（只保证段结构合法，熵编码数据为随机字节），用于基准测试
+struct SynthOptions {
+  uint32_t seed = 1;
+  uint16_t width = 4000;
+  uint16_t height = 3000;
+
+  bool jfif = true;
+  size_t exif_entries = 0;   // EXIF IFD 条目数（0 表示不写 EXIF）
+  bool exif_gps = false;     // 附带 GPS IFD
+  bool exif_big_endian = false;
+  size_t xmp_bytes = 0;      // XMP 有效 XML 大小（0 表示不写 XMP）
+  size_t xmp_padding = 2048; // XMP 尾部空白填充
+  size_t icc_bytes = 0;      // ICC profile 总大小（0 表示不写 ICC）
+  size_t icc_chunk_bytes = 65519; // 每个 APP2 段承载的 profile 字节数
+  size_t app_segments = 0;   // 额外的未知 APPn 段数量
+  size_t app_segment_bytes = 256;
+  bool adobe = false;
+  size_t com_bytes = 0;
+
+  size_t scan_bytes = 64 * 1024;  // 熵编码数据大小
+  double stuffing_ratio = 1.0 / 256; // 0xFF00 stuffing 出现概率
+  size_t restart_interval = 0;    // 每隔多少字节插入 RSTn（0 表示不插入）
+};
+
+std::vector<uint8_t> synthesize_jpeg(const SynthOptions &opt);
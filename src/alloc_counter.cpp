@@ -0,0 +1,31 @@
+// alloc_counter.cpp
+#include "alloc_counter.h"
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t t_allocations = 0;
+
+uint64_t thread_allocation_count() { return t_allocations; }
+
+void *operator new(std::size_t n) {
+  t_allocations++;
+  if (void *p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n) { return ::operator new(n); }
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+  t_allocations++;
+  return std::malloc(n ? n : 1);
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept {
+  return ::operator new(n, std::nothrow);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
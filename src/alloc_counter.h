@@ -0,0 +1,7 @@
+// alloc_counter.h
+#pragma once
+#include <cstdint>
+
+// 当前线程累计的堆分配次数（由 alloc_counter.cpp 替换全局 operator new 统计，
+// 只链接进命令行工具，库本身不替换分配器）
+uint64_t thread_allocation_count();
@@ -0,0 +1,155 @@
+// batch.cpp
+#include "batch.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static bool has_jpeg_extension(const fs::path &p) {
+  std::string ext = p.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return (char)std::tolower(c); });
+  return ext == ".jpg" || ext == ".jpeg" || ext == ".jpe" || ext == ".jfif";
+}
+
+static void collect_directory(const fs::path &dir,
+                              std::vector<std::string> &paths) {
+  std::vector<std::string> found;
+  std::error_code ec;
+  auto opts = fs::directory_options::skip_permission_denied;
+  for (fs::recursive_directory_iterator it(dir, opts, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    std::error_code fec;
+    if (it->is_regular_file(fec) && has_jpeg_extension(it->path()))
+      found.push_back(it->path().string());
+  }
+  // 目录遍历顺序依赖文件系统，排序后输出才可复现
+  std::sort(found.begin(), found.end());
+  paths.insert(paths.end(), found.begin(), found.end());
+}
+
+size_t collect_inputs(const std::vector<std::string> &args,
+                      std::vector<std::string> &paths, const I18n &i18n,
+                      std::ostream &err) {
+  size_t failures = 0;
+  for (const auto &arg : args) {
+    if (arg.size() > 1 && arg[0] == '@') {
+      std::ifstream list(arg.substr(1));
+      if (!list) {
+        err << i18n.t(Msg::ErrorListFile) << ": " << arg.substr(1) << "\n";
+        failures++;
+        continue;
+      }
+      std::string line;
+      while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r')
+          line.pop_back();
+        if (!line.empty())
+          paths.push_back(line);
+      }
+      continue;
+    }
+    std::error_code ec;
+    if (fs::is_directory(arg, ec)) {
+      collect_directory(arg, paths);
+      continue;
+    }
+    paths.push_back(arg);
+  }
+  return failures;
+}
+
+size_t run_batch(const std::vector<std::string> &paths,
+                 const BatchOptions &opt, const FileJob &job,
+                 std::ostream &out, std::ostream &err) {
+  size_t failures = run_batch(
+      paths, opt, job, [&out](const std::string &block) { out << block; }, err);
+  out.flush();
+  return failures;
+}
+
+size_t run_batch(const std::vector<std::string> &paths,
+                 const BatchOptions &opt, const FileJob &job,
+                 const BlockSink &out, std::ostream &err) {
+  struct Slot {
+    std::string out;
+    std::string err;
+    bool ok = false;
+    bool done = false;
+  };
+
+  const size_t n = paths.size();
+  const bool ordered = opt.order == OutputOrder::Input;
+  std::vector<Slot> slots(ordered ? n : 0);
+  std::atomic<size_t> next{0};
+  std::mutex mu;
+  std::condition_variable cv;
+  size_t next_emit = 0; // Input 顺序下下一个要输出的文件
+  size_t failures = 0;
+  bool emitted = false;
+
+  auto emit = [&](const std::string &o, const std::string &e, bool ok) {
+    if (!o.empty()) {
+      if (emitted && !opt.separator.empty())
+        out(opt.separator);
+      emitted = true;
+      out(o);
+    }
+    err << e;
+    if (!ok)
+      failures++;
+  };
+
+  auto worker = [&]() {
+    while (true) {
+      size_t i = next.fetch_add(1);
+      if (i >= n)
+        return;
+      if (ordered && opt.max_pending > 0) {
+        std::unique_lock<std::mutex> lk(mu);
+        cv.wait(lk, [&] { return i < next_emit + opt.max_pending; });
+      }
+
+      std::string o, e;
+      bool ok = job(paths[i], o, e);
+
+      std::lock_guard<std::mutex> lk(mu);
+      if (!ordered) {
+        emit(o, e, ok);
+        continue;
+      }
+      slots[i].out = std::move(o);
+      slots[i].err = std::move(e);
+      slots[i].ok = ok;
+      slots[i].done = true;
+      while (next_emit < n && slots[next_emit].done) {
+        Slot &s = slots[next_emit];
+        emit(s.out, s.err, s.ok);
+        std::string().swap(s.out); // 输出后立即释放暂存
+        std::string().swap(s.err);
+        next_emit++;
+      }
+      cv.notify_all();
+    }
+  };
+
+  unsigned jobs = std::max(1u, opt.jobs);
+  jobs = (unsigned)std::min<size_t>(jobs, std::max<size_t>(n, 1));
+  if (jobs == 1) {
+    worker();
+  } else {
+    std::vector<std::thread> pool;
+    pool.reserve(jobs);
+    for (unsigned t = 0; t < jobs; t++)
+      pool.emplace_back(worker);
+    for (auto &th : pool)
+      th.join();
+  }
+  return failures;
+}
@@ -0,0 +1,43 @@
+// batch.h
+#pragma once
+#include "i18n.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 展开命令行输入：普通路径、@listfile（每行一个路径）、目录（递归收集 JPEG 文件）
+// 无法读取的输入按 i18n 的语言写入 err 并计入返回值
+size_t collect_inputs(const std::vector<std::string> &args,
+                      std::vector<std::string> &paths, const I18n &i18n,
+                      std::ostream &err);
+
+enum class OutputOrder {
+  Input,      // 按输入顺序输出（需要暂存先完成的结果）
+  Completion, // 谁先完成谁先输出
+};
+
+struct BatchOptions {
+  unsigned jobs = 1;
+  OutputOrder order = OutputOrder::Input;
+  // Input 顺序下允许领先于当前输出位置的最大文件数（限制暂存内存）
+  size_t max_pending = 1024;
+  // 写在相邻两个非空输出块之间（如 JSON 数组元素间的逗号）
+  std::string separator;
+};
+
+// 处理单个文件：输出写入 out/err 字符串，返回 false 表示失败
+using FileJob = std::function<bool(const std::string &path, std::string &out,
+                                   std::string &err)>;
+
+// 接收一个完整的输出块（含 separator）；调用时持有批处理的锁，按输出顺序调用
+using BlockSink = std::function<void(const std::string &block)>;
+
+// 在 jobs 个工作线程上处理所有文件，每个文件的输出块完整写出不交错；返回失败数
+size_t run_batch(const std::vector<std::string> &paths,
+                 const BatchOptions &opt, const FileJob &job,
+                 std::ostream &out, std::ostream &err);
+// 输出块交给 sink 处理（如汇总成列式文件），不直接写流
+size_t run_batch(const std::vector<std::string> &paths,
+                 const BatchOptions &opt, const FileJob &job,
+                 const BlockSink &out, std::ostream &err);
@@ -0,0 +1,96 @@
+// byte_source.cpp
+#include "byte_source.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+size_t MemorySource::read_at(uint64_t off, uint8_t *dst, size_t n) {
+  if (off >= data_.size())
+    return 0;
+  size_t take = std::min<uint64_t>(n, data_.size() - off);
+  std::memcpy(dst, data_.data() + off, take);
+  io_.read_calls++;
+  io_.bytes_read += take;
+  return take;
+}
+
+FileSource::FileSource(const char *path) {
+  f_ = std::fopen(path, "rb");
+  // 调用方（FileReader）自己做块缓冲，关掉 stdio 的缓冲避免二次拷贝
+  if (f_)
+    std::setvbuf(f_, nullptr, _IONBF, 0);
+}
+FileSource::~FileSource() {
+  if (f_)
+    std::fclose(f_);
+}
+
+bool FileSource::seek(uint64_t off) {
+#if defined(_WIN32)
+  bool ok = _fseeki64(f_, (int64_t)off, SEEK_SET) == 0;
+#else
+  bool ok = fseeko(f_, (off_t)off, SEEK_SET) == 0;
+#endif
+  if (ok)
+    pos_ = off;
+  io_.seek_calls++;
+  return ok;
+}
+
+size_t FileSource::read_at(uint64_t off, uint8_t *dst, size_t n) {
+  if (off != pos_ && !seek(off))
+    return 0;
+  size_t got = std::fread(dst, 1, n, f_);
+  pos_ += got;
+  io_.read_calls++;
+  io_.bytes_read += got;
+  return got;
+}
+
+bool FileSource::size(uint64_t &out) {
+#if defined(_WIN32)
+  bool ok = _fseeki64(f_, 0, SEEK_END) == 0;
+  if (ok)
+    out = (uint64_t)_ftelli64(f_);
+#else
+  bool ok = fseeko(f_, 0, SEEK_END) == 0;
+  if (ok)
+    out = (uint64_t)ftello(f_);
+#endif
+  // 恢复到之前的位置，保证下一次顺序读取无需 seek
+  return seek(pos_) && ok;
+}
+
+size_t StreamSource::read_at(uint64_t off, uint8_t *dst, size_t n) {
+  if (off < pos_)
+    return 0;
+  while (pos_ < off) {
+    uint8_t skip[4096];
+    size_t want = (size_t)std::min<uint64_t>(sizeof(skip), off - pos_);
+    size_t got = std::fread(skip, 1, want, f_);
+    io_.read_calls++;
+    io_.bytes_read += got;
+    pos_ += got;
+    if (got < want)
+      return 0;
+  }
+  size_t got = std::fread(dst, 1, n, f_);
+  pos_ += got;
+  io_.read_calls++;
+  io_.bytes_read += got;
+  return got;
+}
+
+size_t RangedSource::read_at(uint64_t off, uint8_t *dst, size_t n) {
+  size_t got = fetch(off, dst, n);
+  io_.range_requests++;
+  io_.read_calls++;
+  io_.bytes_read += got;
+  return got;
+}
+
+size_t LocalRangedSource::fetch(uint64_t off, uint8_t *dst, size_t n) {
+  if (latency_us_)
+    std::this_thread::sleep_for(std::chrono::microseconds(latency_us_));
+  return file_.read_at(off, dst, n);
+}
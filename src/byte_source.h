@@ -0,0 +1,125 @@
+// byte_source.h
+#pragma once
+#include "jpeg_types.h"
+#include "stats.h"
+#include <cstdint>
+#include <cstdio>
+
+// 可随机读取的字节来源：文件、内存映射、内存缓冲等。
+// 索引器和段加载只通过这个接口取数据，同一套 marker 逻辑适用于所有来源
+class ByteSource {
+public:
+  virtual ~ByteSource() = default;
+
+  // 从 off 起读取最多 n 字节到 dst，返回实际读取的字节数（0 表示越界或出错）
+  virtual size_t read_at(uint64_t off, uint8_t *dst, size_t n) = 0;
+  virtual bool size(uint64_t &out) = 0;
+
+  // 整体常驻内存的来源返回连续视图，读取方可以直接引用而不拷贝
+  virtual ByteSpan contiguous() const { return ByteSpan(); }
+
+  // 单次请求代价高的来源返回建议的最小读取量，顺序读取方据此放大块缓冲，
+  // 用多读的字节换更少的请求；0 表示没有偏好
+  virtual size_t preferred_read_size() const { return 0; }
+
+  // 只能向前读取的来源（管道、标准输入、套接字）返回 false，
+  // 读取方不能回头读取已经经过的数据
+  virtual bool seekable() const { return true; }
+
+  // I/O 计数（--stats 用）；零拷贝访问由读取方通过 count_view 登记
+  const IoCounters &io() const { return io_; }
+  void count_view(uint64_t n) { io_.bytes_viewed += n; }
+
+protected:
+  IoCounters io_;
+};
+
+// 调用方持有的内存区域（不拷贝，生命周期由调用方保证）
+class MemorySource : public ByteSource {
+public:
+  MemorySource(const uint8_t *data, size_t len) : data_(data, len) {}
+  explicit MemorySource(ByteSpan data) : data_(data) {}
+
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) override;
+  bool size(uint64_t &out) override {
+    out = data_.size();
+    return true;
+  }
+  ByteSpan contiguous() const override { return data_; }
+
+private:
+  ByteSpan data_;
+};
+
+// 基于 FILE* 的文件来源；记录当前位置，顺序读取时不重复 seek
+class FileSource : public ByteSource {
+public:
+  explicit FileSource(const char *path);
+  ~FileSource() override;
+  FileSource(const FileSource &) = delete;
+  FileSource &operator=(const FileSource &) = delete;
+  bool ok() const { return f_ != nullptr; }
+
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) override;
+  bool size(uint64_t &out) override;
+
+private:
+  bool seek(uint64_t off);
+
+  FILE *f_ = nullptr;
+  uint64_t pos_ = 0;
+};
+
+// 只能顺序读取的 FILE*（标准输入、管道、套接字）：read_at 只接受不小于当前位置的偏移，
+// 中间跳过的数据读出后丢弃，不缓存。不拥有 FILE*，也不知道总长度
+class StreamSource : public ByteSource {
+public:
+  explicit StreamSource(FILE *f) : f_(f) {}
+
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) override;
+  bool size(uint64_t &) override { return false; }
+  bool seekable() const override { return false; }
+
+private:
+  FILE *f_ = nullptr;
+  uint64_t pos_ = 0;
+};
+
+// 按区间拉取的存储（对象存储的 ranged GET 等）：每次 read_at 都是一次独立请求，
+// 代价主要在请求次数而不是字节数。读取方应先合并相邻区间（见 SegmentLoader），
+// FileReader 的块缓冲也会把顺序小读取合并成整块请求。子类实现 fetch 与 size
+class RangedSource : public ByteSource {
+public:
+  static constexpr size_t kDefaultRequestSize = 256 * 1024;
+
+  explicit RangedSource(size_t request_size = kDefaultRequestSize)
+      : request_size_(request_size) {}
+
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) final;
+  size_t preferred_read_size() const override { return request_size_; }
+
+protected:
+  // 拉取 [off, off+n)，返回实际字节数（0 表示越界或出错）
+  virtual size_t fetch(uint64_t off, uint8_t *dst, size_t n) = 0;
+
+private:
+  size_t request_size_;
+};
+
+// 本地文件模拟的 ranged 后端：没有对象存储时验证请求数，
+// latency_us 非 0 时每个请求额外等待，模拟网络往返
+class LocalRangedSource : public RangedSource {
+public:
+  explicit LocalRangedSource(const char *path, uint32_t latency_us = 0)
+      : file_(path), latency_us_(latency_us) {}
+  bool ok() const { return file_.ok(); }
+
+  bool size(uint64_t &out) override { return file_.size(out); }
+
+protected:
+  size_t fetch(uint64_t off, uint8_t *dst, size_t n) override;
+
+private:
+  FileSource file_;
+  uint32_t latency_us_ = 0;
+};
@@ -0,0 +1,574 @@
+// columnar.cpp
+#include "columnar.h"
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <unordered_map>
+
+namespace {
+
+struct ColumnDef {
+  std::string_view name;
+  ColumnType type;
+};
+
+// 按 MetaColumn 的顺序排列
+constexpr ColumnDef kMetaColumns[] = {
+    {"path", ColumnType::String},      {"width", ColumnType::U32},
+    {"height", ColumnType::U32},       {"precision", ColumnType::U32},
+    {"components", ColumnType::U32},   {"orientation", ColumnType::U32},
+    {"make", ColumnType::String},      {"model", ColumnType::String},
+    {"datetime", ColumnType::String},  {"latitude", ColumnType::F64},
+    {"longitude", ColumnType::F64},    {"icc_size", ColumnType::U32},
+    {"xmp_size", ColumnType::U32},     {"segments", ColumnType::U32},
+    {"app_segments", ColumnType::U32},
+};
+static_assert(sizeof(kMetaColumns) / sizeof(kMetaColumns[0]) ==
+                  (size_t)MetaColumn::Count,
+              "column table out of sync with MetaColumn");
+
+constexpr char kMagic[4] = {'J', 'P', 'I', 'C'};
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kTailSize = 12; // u64 footer 偏移 + magic
+constexpr size_t kDictHeaderSize = 8;
+
+void put_le32(std::string &out, uint32_t v) {
+  char b[4] = {(char)v, (char)(v >> 8), (char)(v >> 16), (char)(v >> 24)};
+  out.append(b, 4);
+}
+void put_le64(std::string &out, uint64_t v) {
+  put_le32(out, (uint32_t)v);
+  put_le32(out, (uint32_t)(v >> 32));
+}
+void put_f64(std::string &out, double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, 8);
+  put_le64(out, bits);
+}
+
+uint32_t le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+uint64_t le64(const uint8_t *p) {
+  return (uint64_t)le32(p) | ((uint64_t)le32(p + 4) << 32);
+}
+double f64_at(const uint8_t *p) {
+  uint64_t bits = le64(p);
+  double v;
+  std::memcpy(&v, &bits, 8);
+  return v;
+}
+
+// 带边界检查的顺序读取（footer 与行记录）
+class Cursor {
+public:
+  explicit Cursor(ByteSpan s) : s_(s) {}
+  bool u8(uint8_t &v) {
+    if (!take(1))
+      return false;
+    v = *at(1);
+    return true;
+  }
+  bool u32(uint32_t &v) {
+    if (!take(4))
+      return false;
+    v = le32(at(4));
+    return true;
+  }
+  bool u64(uint64_t &v) {
+    if (!take(8))
+      return false;
+    v = le64(at(8));
+    return true;
+  }
+  bool f64(double &v) {
+    if (!take(8))
+      return false;
+    v = f64_at(at(8));
+    return true;
+  }
+  bool bytes(size_t n, std::string_view &v) {
+    if (!take(n))
+      return false;
+    v = std::string_view((const char *)at(n), n);
+    return true;
+  }
+  bool done() const { return pos_ == s_.size(); }
+
+private:
+  bool take(size_t n) {
+    if (n > s_.size() - pos_)
+      return false;
+    pos_ += n;
+    return true;
+  }
+  const uint8_t *at(size_t n) const { return s_.data() + pos_ - n; }
+
+  ByteSpan s_;
+  size_t pos_ = 0;
+};
+
+std::string_view exif_ascii(const ExifResult &exif, const ExifTag *tag) {
+  if (!tag || tag->type != 2)
+    return std::string_view();
+  return exif_value(exif, *tag).ascii();
+}
+
+} // namespace
+
+void make_meta_record(const std::string &path, const JpegInfo &info,
+                      MetaRecord &out) {
+  out = MetaRecord();
+  out.path = path;
+  if (!info.sof.empty()) {
+    const SofInfo &sof = info.sof.front();
+    out.width = sof.width;
+    out.height = sof.height;
+    out.precision = sof.precision;
+    out.components = sof.components;
+  }
+  // 多个 EXIF 段时取第一个有该字段的
+  for (const auto &exif : info.exif) {
+    if (out.orientation == 0) {
+      const ExifTag *t = exif.ifd0.find(0x0112);
+      if (t && (t->type == 3 || t->type == 4))
+        out.orientation = exif_value(exif, *t).uint();
+    }
+    if (out.make.empty())
+      out.make = exif_ascii(exif, exif.ifd0.find(0x010F));
+    if (out.model.empty())
+      out.model = exif_ascii(exif, exif.ifd0.find(0x0110));
+    if (out.datetime.empty()) {
+      out.datetime = exif_ascii(exif, exif.exif_ifd.find(0x9003));
+      if (out.datetime.empty())
+        out.datetime = exif_ascii(exif, exif.ifd0.find(0x0132));
+    }
+    if (std::isnan(out.latitude) && exif.latitude && exif.longitude &&
+        exif.latitude->valid && exif.longitude->valid) {
+      out.latitude = exif.latitude->deg;
+      out.longitude = exif.longitude->deg;
+    }
+  }
+  if (info.icc.has_value())
+    out.icc_size = info.icc->total_len;
+  for (const auto &x : info.xmp)
+    out.xmp_size += x.effective_len;
+  out.segments = (uint32_t)info.index.segments.size();
+  for (const auto &s : info.index.segments)
+    out.app_segments += s.marker >= 0xFFE0 && s.marker <= 0xFFEF;
+}
+
+ExifTagFilter meta_record_exif_tags() {
+  ExifTagFilter f;
+  for (const char *name :
+       {"Orientation", "Make", "Model", "DateTimeOriginal", "DateTime",
+        "GPSLatitudeRef", "GPSLatitude", "GPSLongitudeRef", "GPSLongitude"})
+    f.add(name);
+  return f;
+}
+
+static void put_string(std::string &out, std::string_view s) {
+  put_le32(out, (uint32_t)s.size());
+  out.append(s.data(), s.size());
+}
+
+void encode_meta_record(const MetaRecord &rec, std::string &out) {
+  put_string(out, rec.path);
+  for (uint32_t v : {rec.width, rec.height, rec.precision, rec.components,
+                     rec.orientation})
+    put_le32(out, v);
+  put_string(out, rec.make);
+  put_string(out, rec.model);
+  put_string(out, rec.datetime);
+  put_f64(out, rec.latitude);
+  put_f64(out, rec.longitude);
+  for (uint32_t v : {rec.icc_size, rec.xmp_size, rec.segments,
+                     rec.app_segments})
+    put_le32(out, v);
+}
+
+bool decode_meta_record(std::string_view in, MetaRecord &out) {
+  Cursor c(ByteSpan((const uint8_t *)in.data(), in.size()));
+  auto str = [&c](std::string &s) {
+    uint32_t n = 0;
+    std::string_view v;
+    if (!c.u32(n) || !c.bytes(n, v))
+      return false;
+    s.assign(v);
+    return true;
+  };
+  return str(out.path) && c.u32(out.width) && c.u32(out.height) &&
+         c.u32(out.precision) && c.u32(out.components) &&
+         c.u32(out.orientation) && str(out.make) && str(out.model) &&
+         str(out.datetime) && c.f64(out.latitude) && c.f64(out.longitude) &&
+         c.u32(out.icc_size) && c.u32(out.xmp_size) && c.u32(out.segments) &&
+         c.u32(out.app_segments) && c.done();
+}
+
+// ---------------------------------------------------------------------------
+// ColumnarWriter
+
+ColumnarWriter::ColumnarWriter(std::ostream &out, const ColumnarOptions &opt)
+    : out_(out), opt_(opt) {
+  if (opt_.row_group_rows == 0)
+    opt_.row_group_rows = 1;
+  std::string header(kMagic, 4);
+  put_le32(header, kColumnarVersion);
+  write(header);
+}
+
+void ColumnarWriter::put(MetaColumn c, std::string_view v) {
+  Column &col = cols_[(size_t)c];
+  col.bytes.append(v.data(), v.size());
+  col.ends.push_back((uint32_t)col.bytes.size());
+}
+
+void ColumnarWriter::add(const MetaRecord &rec) {
+  put(MetaColumn::Path, rec.path);
+  put(MetaColumn::Width, rec.width);
+  put(MetaColumn::Height, rec.height);
+  put(MetaColumn::Precision, rec.precision);
+  put(MetaColumn::Components, rec.components);
+  put(MetaColumn::Orientation, rec.orientation);
+  put(MetaColumn::Make, rec.make);
+  put(MetaColumn::Model, rec.model);
+  put(MetaColumn::DateTime, rec.datetime);
+  put(MetaColumn::Latitude, rec.latitude);
+  put(MetaColumn::Longitude, rec.longitude);
+  put(MetaColumn::IccSize, rec.icc_size);
+  put(MetaColumn::XmpSize, rec.xmp_size);
+  put(MetaColumn::Segments, rec.segments);
+  put(MetaColumn::AppSegments, rec.app_segments);
+  rows_++;
+  // 字符串偏移是 u32，单个行组的字符串超过 4 GiB 之前提前结束行组
+  bool big = false;
+  for (const auto &col : cols_)
+    big |= col.bytes.size() > 0xC0000000u;
+  if (++group_rows_ == opt_.row_group_rows || big)
+    flush_group();
+}
+
+// 不同值足够少时写字典 + 定宽下标，否则逐行写出
+ColumnEncoding ColumnarWriter::encode_strings(const Column &col,
+                                              uint32_t rows) {
+  std::unordered_map<std::string_view, uint32_t> dict;
+  std::vector<uint32_t> codes;
+  codes.reserve(rows);
+  std::vector<std::string_view> entries;
+  const size_t max_entries = (size_t)(rows * opt_.max_dictionary_ratio);
+  uint32_t begin = 0;
+  for (uint32_t i = 0; i < rows && entries.size() <= max_entries; i++) {
+    std::string_view s(col.bytes.data() + begin, col.ends[i] - begin);
+    begin = col.ends[i];
+    auto it = dict.emplace(s, (uint32_t)entries.size()).first;
+    if (it->second == entries.size())
+      entries.push_back(s);
+    codes.push_back(it->second);
+  }
+
+  if (entries.size() > max_entries) {
+    put_le32(buf_, 0);
+    for (uint32_t e : col.ends)
+      put_le32(buf_, e);
+    buf_ += col.bytes;
+    return ColumnEncoding::Plain;
+  }
+
+  uint8_t width = entries.size() <= 0x100 ? 1 : entries.size() <= 0x10000 ? 2 : 4;
+  put_le32(buf_, (uint32_t)entries.size());
+  buf_ += (char)width;
+  buf_.append(3, '\0');
+  uint32_t off = 0;
+  put_le32(buf_, 0);
+  for (auto e : entries)
+    put_le32(buf_, off += (uint32_t)e.size());
+  for (auto e : entries)
+    buf_.append(e.data(), e.size());
+  for (uint32_t c : codes)
+    for (uint8_t b = 0; b < width; b++)
+      buf_ += (char)(c >> (8 * b));
+  return ColumnEncoding::Dictionary;
+}
+
+void ColumnarWriter::flush_group() {
+  if (group_rows_ == 0)
+    return;
+  for (size_t c = 0; c < (size_t)MetaColumn::Count; c++) {
+    Column &col = cols_[c];
+    buf_.clear();
+    Chunk chunk;
+    switch (kMetaColumns[c].type) {
+    case ColumnType::U32:
+      for (uint32_t v : col.u32)
+        put_le32(buf_, v);
+      break;
+    case ColumnType::F64:
+      for (double v : col.f64)
+        put_f64(buf_, v);
+      break;
+    case ColumnType::String:
+      chunk.encoding = encode_strings(col, group_rows_);
+      break;
+    }
+    chunk.offset = pos_;
+    chunk.size = buf_.size();
+    chunks_.push_back(chunk);
+    write(buf_);
+    col.u32.clear();
+    col.f64.clear();
+    col.bytes.clear();
+    col.ends.clear();
+  }
+  group_sizes_.push_back(group_rows_);
+  group_rows_ = 0;
+}
+
+void ColumnarWriter::write(const std::string &bytes) {
+  out_.write(bytes.data(), (std::streamsize)bytes.size());
+  pos_ += bytes.size();
+}
+
+bool ColumnarWriter::finish() {
+  if (finished_)
+    return (bool)out_;
+  finished_ = true;
+  flush_group();
+
+  uint64_t footer_off = pos_;
+  std::string f;
+  put_le32(f, (uint32_t)MetaColumn::Count);
+  for (const auto &def : kMetaColumns) {
+    f += (char)def.type;
+    f += (char)def.name.size();
+    f.append(def.name.data(), def.name.size());
+  }
+  put_le32(f, (uint32_t)group_sizes_.size());
+  for (size_t g = 0; g < group_sizes_.size(); g++) {
+    put_le32(f, group_sizes_[g]);
+    for (size_t c = 0; c < (size_t)MetaColumn::Count; c++) {
+      const Chunk &ch = chunks_[g * (size_t)MetaColumn::Count + c];
+      f += (char)ch.encoding;
+      put_le64(f, ch.offset);
+      put_le64(f, ch.size);
+    }
+  }
+  put_le64(f, footer_off);
+  f.append(kMagic, 4);
+  write(f);
+  out_.flush();
+  return (bool)out_;
+}
+
+// ---------------------------------------------------------------------------
+// ColumnChunk
+
+ColumnChunk::ColumnChunk(ColumnType type, ColumnEncoding enc, uint32_t rows,
+                         ByteSpan data)
+    : type_(type), enc_(enc), rows_(rows), data_(data) {
+  if (type_ != ColumnType::String)
+    return;
+  // 结构已由 ColumnarReader 校验
+  if (enc_ == ColumnEncoding::Plain) {
+    offsets_ = data_.data();
+    size_t head = ((size_t)rows_ + 1) * 4;
+    bytes_ = data_.subspan(head);
+    return;
+  }
+  dict_n_ = le32(data_.data());
+  index_width_ = data_[4];
+  offsets_ = data_.data() + kDictHeaderSize;
+  size_t head = kDictHeaderSize + ((size_t)dict_n_ + 1) * 4;
+  uint32_t dict_bytes = le32(offsets_ + (size_t)dict_n_ * 4);
+  bytes_ = data_.subspan(head, dict_bytes);
+  indices_ = data_.data() + head + dict_bytes;
+}
+
+uint32_t ColumnChunk::u32(size_t row) const {
+  if (type_ != ColumnType::U32 || row >= rows_)
+    return 0;
+  return le32(data_.data() + row * 4);
+}
+
+double ColumnChunk::f64(size_t row) const {
+  if (type_ != ColumnType::F64 || row >= rows_)
+    return std::numeric_limits<double>::quiet_NaN();
+  return f64_at(data_.data() + row * 8);
+}
+
+std::string_view ColumnChunk::slice(const uint8_t *offsets, uint32_t i,
+                                    ByteSpan bytes) const {
+  uint32_t b = le32(offsets + (size_t)i * 4);
+  uint32_t e = le32(offsets + (size_t)i * 4 + 4);
+  if (b > e || e > bytes.size())
+    return std::string_view();
+  return std::string_view((const char *)bytes.data() + b, e - b);
+}
+
+uint32_t ColumnChunk::code(size_t row) const {
+  if (!indices_ || row >= rows_)
+    return 0;
+  const uint8_t *p = indices_ + row * index_width_;
+  uint32_t c = 0;
+  for (uint8_t b = 0; b < index_width_; b++)
+    c |= (uint32_t)p[b] << (8 * b);
+  return c;
+}
+
+std::string_view ColumnChunk::dict_entry(uint32_t code) const {
+  if (code >= dict_n_)
+    return std::string_view();
+  return slice(offsets_, code, bytes_);
+}
+
+std::string_view ColumnChunk::str(size_t row) const {
+  if (type_ != ColumnType::String || row >= rows_)
+    return std::string_view();
+  if (enc_ == ColumnEncoding::Dictionary)
+    return dict_entry(code(row));
+  return slice(offsets_, (uint32_t)row, bytes_);
+}
+
+// ---------------------------------------------------------------------------
+// ColumnarReader
+
+ColumnarReader::ColumnarReader(const char *path) : file_(path) {
+  for (int &c : meta_cols_)
+    c = -1;
+  ok_ = file_.ok() && open();
+}
+
+bool ColumnarReader::open() {
+  ByteSpan all = file_.span();
+  if (all.size() < kHeaderSize + kTailSize ||
+      std::memcmp(all.data(), kMagic, 4) != 0 ||
+      le32(all.data() + 4) != kColumnarVersion ||
+      std::memcmp(all.end() - 4, kMagic, 4) != 0)
+    return false;
+  uint64_t footer_off = le64(all.end() - kTailSize);
+  if (footer_off < kHeaderSize || footer_off > all.size() - kTailSize)
+    return false;
+
+  Cursor c(all.subspan((size_t)footer_off,
+                       all.size() - kTailSize - (size_t)footer_off));
+  uint32_t ncols = 0;
+  if (!c.u32(ncols) || ncols == 0 || ncols > 255)
+    return false;
+  for (uint32_t i = 0; i < ncols; i++) {
+    uint8_t type = 0, len = 0;
+    std::string_view name;
+    if (!c.u8(type) || !c.u8(len) || !c.bytes(len, name))
+      return false;
+    if (type < (uint8_t)ColumnType::U32 || type > (uint8_t)ColumnType::String)
+      return false;
+    columns_.push_back({std::string(name), (ColumnType)type});
+  }
+
+  uint32_t ngroups = 0;
+  if (!c.u32(ngroups))
+    return false;
+  for (uint32_t g = 0; g < ngroups; g++) {
+    uint32_t rows = 0;
+    if (!c.u32(rows))
+      return false;
+    for (uint32_t i = 0; i < ncols; i++) {
+      ChunkRef ref;
+      uint8_t enc = 0;
+      if (!c.u8(enc) || !c.u64(ref.offset) || !c.u64(ref.size) ||
+          enc > (uint8_t)ColumnEncoding::Dictionary)
+        return false;
+      ref.encoding = (ColumnEncoding)enc;
+      if (ref.offset < kHeaderSize || ref.offset > footer_off ||
+          ref.size > footer_off - ref.offset ||
+          !valid_chunk(columns_[i].type, ref, rows))
+        return false;
+      chunks_.push_back(ref);
+    }
+    group_rows_.push_back(rows);
+    rows_ += rows;
+  }
+  if (!c.done())
+    return false;
+
+  for (size_t m = 0; m < (size_t)MetaColumn::Count; m++) {
+    int i = find_column(kMetaColumns[m].name);
+    if (i >= 0 && columns_[(size_t)i].type == kMetaColumns[m].type)
+      meta_cols_[m] = i;
+  }
+  return true;
+}
+
+// 列块长度必须与行数、编码一致，之后按行访问只需检查字符串偏移
+bool ColumnarReader::valid_chunk(ColumnType type, const ChunkRef &ref,
+                                 uint32_t rows) const {
+  const uint8_t *p = file_.data() + ref.offset;
+  if (type != ColumnType::String)
+    return ref.encoding == ColumnEncoding::Plain &&
+           ref.size == (uint64_t)rows * (type == ColumnType::U32 ? 4 : 8);
+  if (ref.encoding == ColumnEncoding::Plain) {
+    uint64_t head = ((uint64_t)rows + 1) * 4;
+    return ref.size >= head && le32(p + head - 4) == ref.size - head;
+  }
+  if (ref.size < kDictHeaderSize)
+    return false;
+  uint64_t n = le32(p);
+  uint8_t width = p[4];
+  if (width != 1 && width != 2 && width != 4)
+    return false;
+  uint64_t head = kDictHeaderSize + (n + 1) * 4;
+  if (ref.size < head)
+    return false;
+  uint64_t dict_bytes = le32(p + head - 4);
+  return ref.size == head + dict_bytes + (uint64_t)rows * width;
+}
+
+int ColumnarReader::find_column(std::string_view name) const {
+  for (size_t i = 0; i < columns_.size(); i++)
+    if (columns_[i].name == name)
+      return (int)i;
+  return -1;
+}
+
+ColumnChunk ColumnarReader::chunk(size_t group, size_t column) const {
+  if (group >= group_rows_.size() || column >= columns_.size())
+    return ColumnChunk();
+  const ChunkRef &ref = chunks_[group * columns_.size() + column];
+  return ColumnChunk(columns_[column].type, ref.encoding, group_rows_[group],
+                     ByteSpan(file_.data() + ref.offset, (size_t)ref.size));
+}
+
+bool ColumnarReader::read_record(size_t group, uint32_t row,
+                                 MetaRecord &out) const {
+  if (group >= group_rows_.size() || row >= group_rows_[group])
+    return false;
+  out = MetaRecord();
+  auto col = [&](MetaColumn m) {
+    int i = meta_cols_[(size_t)m];
+    return i < 0 ? ColumnChunk() : chunk(group, (size_t)i);
+  };
+  auto str = [&](MetaColumn m, std::string &s) { s.assign(col(m).str(row)); };
+  auto u32 = [&](MetaColumn m, uint32_t &v) {
+    if (meta_cols_[(size_t)m] >= 0)
+      v = col(m).u32(row);
+  };
+  auto f64 = [&](MetaColumn m, double &v) {
+    if (meta_cols_[(size_t)m] >= 0)
+      v = col(m).f64(row);
+  };
+  str(MetaColumn::Path, out.path);
+  u32(MetaColumn::Width, out.width);
+  u32(MetaColumn::Height, out.height);
+  u32(MetaColumn::Precision, out.precision);
+  u32(MetaColumn::Components, out.components);
+  u32(MetaColumn::Orientation, out.orientation);
+  str(MetaColumn::Make, out.make);
+  str(MetaColumn::Model, out.model);
+  str(MetaColumn::DateTime, out.datetime);
+  f64(MetaColumn::Latitude, out.latitude);
+  f64(MetaColumn::Longitude, out.longitude);
+  u32(MetaColumn::IccSize, out.icc_size);
+  u32(MetaColumn::XmpSize, out.xmp_size);
+  u32(MetaColumn::Segments, out.segments);
+  u32(MetaColumn::AppSegments, out.app_segments);
+  return true;
+}
@@ -0,0 +1,207 @@
+// columnar.h
+// 按列存储的批量元数据文件：每个文件一行，每个字段一列，按行组写出；
+// 重复较多的字符串列（相机厂商、型号等）用字典编码。读取端内存映射后按列零拷贝访问
+#pragma once
+#include "jpeginfo.h"
+#include "mapped_file.h"
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 每个文件导出的字段；缺失的数值为 0，缺失的坐标为 NaN，缺失的字符串为空
+struct MetaRecord {
+  std::string path;
+  uint32_t width = 0; // 第一个 SOF
+  uint32_t height = 0;
+  uint32_t precision = 0;
+  uint32_t components = 0;
+  uint32_t orientation = 0; // EXIF Orientation 1..8
+  std::string make;
+  std::string model;
+  std::string datetime; // DateTimeOriginal，没有时取 DateTime
+  double latitude = std::numeric_limits<double>::quiet_NaN(); // 十进制度
+  double longitude = std::numeric_limits<double>::quiet_NaN();
+  uint32_t icc_size = 0;     // 拼接后的 ICC profile 字节数
+  uint32_t xmp_size = 0;     // 各 XMP 段有效 XML 长度之和
+  uint32_t segments = 0;     // 分区数（含 SOI/EOI）
+  uint32_t app_segments = 0; // APP0..APP15 段数
+};
+
+// 从分析结果提取一行
+void make_meta_record(const std::string &path, const JpegInfo &info,
+                      MetaRecord &out);
+// 导出需要的 EXIF tag（Orientation、Make、Model、日期与 GPS 坐标）
+ExifTagFilter meta_record_exif_tags();
+
+// 一行记录的紧凑序列化，用于在线程间传递（如批处理的输出块），不是文件格式的一部分
+void encode_meta_record(const MetaRecord &rec, std::string &out);
+bool decode_meta_record(std::string_view in, MetaRecord &out);
+
+enum class ColumnType : uint8_t { U32 = 1, F64 = 2, String = 3 };
+enum class ColumnEncoding : uint8_t { Plain = 0, Dictionary = 1 };
+
+// MetaRecord 各字段对应的列，文件中按此顺序写出
+enum class MetaColumn : uint8_t {
+  Path,
+  Width,
+  Height,
+  Precision,
+  Components,
+  Orientation,
+  Make,
+  Model,
+  DateTime,
+  Latitude,
+  Longitude,
+  IccSize,
+  XmpSize,
+  Segments,
+  AppSegments,
+  Count,
+};
+
+struct ColumnInfo {
+  std::string name;
+  ColumnType type = ColumnType::U32;
+};
+
+// 文件布局（整数一律小端）：
+//   "JPIC" u32 版本
+//   行组 0 的各列块，行组 1 的各列块 ...
+//   footer: u32 列数 { u8 类型, u8 名称长度, 名称 }
+//           u32 行组数 { u32 行数 { u8 编码, u64 偏移, u64 长度 } × 列数 }
+//   u64 footer 偏移 "JPIC"
+// 列块：
+//   U32/F64 Plain       行数 × 4/8 字节
+//   String Plain        u32 偏移[行数+1]，字符串字节
+//   String Dictionary   u32 字典项数, u8 下标宽度(1/2/4), 3 字节填充,
+//                       u32 偏移[项数+1]，字典字节，下标[行数]
+constexpr uint32_t kColumnarVersion = 1;
+
+struct ColumnarOptions {
+  uint32_t row_group_rows = 65536;
+  // 一个行组内不同值不超过行数的这个比例时使用字典编码
+  double max_dictionary_ratio = 0.5;
+};
+
+// 顺序写出，不需要 seek（可以写到管道）；析构前调用 finish() 写出 footer
+class ColumnarWriter {
+public:
+  explicit ColumnarWriter(std::ostream &out,
+                          const ColumnarOptions &opt = ColumnarOptions());
+  ColumnarWriter(const ColumnarWriter &) = delete;
+  ColumnarWriter &operator=(const ColumnarWriter &) = delete;
+
+  void add(const MetaRecord &rec);
+  // 写出剩余的行与 footer，返回输出流是否正常
+  bool finish();
+  uint64_t rows() const { return rows_; }
+
+private:
+  struct Column {
+    std::vector<uint32_t> u32;
+    std::vector<double> f64;
+    std::string bytes;          // String：当前行组的字符串拼接
+    std::vector<uint32_t> ends; // String：每行在 bytes 中的结束位置
+  };
+  struct Chunk {
+    ColumnEncoding encoding = ColumnEncoding::Plain;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+  };
+
+  void put(MetaColumn c, uint32_t v) { cols_[(size_t)c].u32.push_back(v); }
+  void put(MetaColumn c, double v) { cols_[(size_t)c].f64.push_back(v); }
+  void put(MetaColumn c, std::string_view v);
+  void flush_group();
+  ColumnEncoding encode_strings(const Column &col, uint32_t rows);
+  void write(const std::string &bytes);
+
+  std::ostream &out_;
+  ColumnarOptions opt_;
+  Column cols_[(size_t)MetaColumn::Count];
+  uint32_t group_rows_ = 0;
+  uint64_t rows_ = 0;
+  uint64_t pos_ = 0;
+  std::string buf_; // 当前列块
+  std::vector<uint32_t> group_sizes_;
+  std::vector<Chunk> chunks_; // 行组 × 列
+  bool finished_ = false;
+};
+
+// 一个行组中一列的只读视图，指向映射区域；行号越界时返回 0/空
+class ColumnChunk {
+public:
+  ColumnChunk() = default;
+  ColumnChunk(ColumnType type, ColumnEncoding enc, uint32_t rows,
+              ByteSpan data);
+
+  ColumnType type() const { return type_; }
+  ColumnEncoding encoding() const { return enc_; }
+  uint32_t rows() const { return rows_; }
+
+  uint32_t u32(size_t row) const;
+  double f64(size_t row) const;
+  std::string_view str(size_t row) const;
+
+  // 字典编码的字符串列：按字典码分组计数时不需要比较字符串；Plain 编码时字典为空
+  uint32_t dict_size() const { return dict_n_; }
+  std::string_view dict_entry(uint32_t code) const;
+  uint32_t code(size_t row) const;
+
+private:
+  std::string_view slice(const uint8_t *offsets, uint32_t i,
+                         ByteSpan bytes) const;
+
+  ColumnType type_ = ColumnType::U32;
+  ColumnEncoding enc_ = ColumnEncoding::Plain;
+  uint32_t rows_ = 0;
+  ByteSpan data_;
+  // String 列解析后的各部分
+  const uint8_t *offsets_ = nullptr; // Plain：行偏移；Dictionary：字典项偏移
+  ByteSpan bytes_;
+  uint32_t dict_n_ = 0;
+  uint8_t index_width_ = 0;
+  const uint8_t *indices_ = nullptr;
+};
+
+// 内存映射读取；打开时校验 footer 与所有列块的边界，之后的访问不再读文件
+class ColumnarReader {
+public:
+  explicit ColumnarReader(const char *path);
+
+  bool ok() const { return ok_; }
+  size_t column_count() const { return columns_.size(); }
+  const ColumnInfo &column(size_t i) const { return columns_[i]; }
+  // 没有该列时返回 -1
+  int find_column(std::string_view name) const;
+
+  size_t row_group_count() const { return group_rows_.size(); }
+  uint32_t row_group_rows(size_t group) const { return group_rows_[group]; }
+  uint64_t row_count() const { return rows_; }
+
+  ColumnChunk chunk(size_t group, size_t column) const;
+  // 按列名组装一行；文件中缺少的列保持默认值
+  bool read_record(size_t group, uint32_t row, MetaRecord &out) const;
+
+private:
+  struct ChunkRef {
+    ColumnEncoding encoding = ColumnEncoding::Plain;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+  };
+
+  bool open();
+  bool valid_chunk(ColumnType type, const ChunkRef &ref, uint32_t rows) const;
+
+  MappedFile file_;
+  bool ok_ = false;
+  std::vector<ColumnInfo> columns_;
+  std::vector<uint32_t> group_rows_;
+  std::vector<ChunkRef> chunks_; // 行组 × 列
+  uint64_t rows_ = 0;
+  int meta_cols_[(size_t)MetaColumn::Count]; // MetaColumn -> 文件中的列，-1 为缺少
+};
@@ -0,0 +1,132 @@
+// entropy_scan.cpp
+#include "entropy_scan.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JPEGINFO_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define JPEGINFO_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+static inline unsigned ctz32(uint32_t v) {
+#if defined(_MSC_VER)
+  unsigned long idx = 0;
+  _BitScanForward(&idx, v);
+  return (unsigned)idx;
+#else
+  return (unsigned)__builtin_ctz(v);
+#endif
+}
+
+// 判断 p[i]==0xFF 处是否为 marker；i+1 必须在范围内
+static inline bool is_marker_at(const uint8_t *p, size_t i) {
+  uint8_t c = p[i + 1];
+  return c != 0x00 && c != 0xFF && !(c >= 0xD0 && c <= 0xD7);
+}
+
+// 处理 [i, n) 的标量尾部（也用于逐个解析 SIMD 命中的候选）
+static EntropyScanResult scan_tail(const uint8_t *p, size_t i, size_t n) {
+  while (i < n) {
+    const uint8_t *ff = (const uint8_t *)std::memchr(p + i, 0xFF, n - i);
+    if (!ff)
+      break;
+    i = (size_t)(ff - p);
+    if (i + 1 >= n)
+      return {false, i};
+    if (is_marker_at(p, i))
+      return {true, i};
+    i += (p[i + 1] == 0xFF) ? 1 : 2;
+  }
+  return {false, n};
+}
+
+[[maybe_unused]] static EntropyScanResult scan_portable(const uint8_t *p, size_t n) {
+  return scan_tail(p, 0, n);
+}
+
+// 逐个解析一个向量块内的 0xFF 候选
+static inline bool resolve_mask(const uint8_t *p, size_t i, size_t n,
+                                uint32_t mask, EntropyScanResult &res) {
+  while (mask) {
+    size_t j = i + ctz32(mask);
+    if (j + 1 >= n) {
+      res = {false, j};
+      return true;
+    }
+    if (is_marker_at(p, j)) {
+      res = {true, j};
+      return true;
+    }
+    mask &= mask - 1;
+  }
+  return false;
+}
+
+#if defined(JPEGINFO_SSE2)
+static EntropyScanResult scan_sse2(const uint8_t *p, size_t n) {
+  const __m128i ff = _mm_set1_epi8((char)0xFF);
+  EntropyScanResult res;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, ff));
+    if (mask && resolve_mask(p, i, n, mask, res))
+      return res;
+  }
+  return scan_tail(p, i, n);
+}
+#endif
+
+#if defined(JPEGINFO_AVX2_DISPATCH)
+__attribute__((target("avx2"))) static EntropyScanResult
+scan_avx2(const uint8_t *p, size_t n) {
+  const __m256i ff = _mm256_set1_epi8((char)0xFF);
+  EntropyScanResult res;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, ff));
+    if (mask && resolve_mask(p, i, n, mask, res))
+      return res;
+  }
+  return scan_tail(p, i, n);
+}
+#endif
+
+using ScanFn = EntropyScanResult (*)(const uint8_t *, size_t);
+
+struct ScanImpl {
+  ScanFn fn;
+  const char *name;
+};
+
+static ScanImpl select_impl() {
+#if defined(JPEGINFO_AVX2_DISPATCH)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return {scan_avx2, "avx2"};
+#endif
+#if defined(JPEGINFO_SSE2)
+  return {scan_sse2, "sse2"};
+#else
+  return {scan_portable, "portable"};
+#endif
+}
+
+static const ScanImpl &impl() {
+  static const ScanImpl s = select_impl();
+  return s;
+}
+
+EntropyScanResult find_entropy_marker(const uint8_t *p, size_t n) {
+  return impl().fn(p, n);
+}
+
+const char *entropy_scan_impl_name() { return impl().name; }
@@ -0,0 +1,18 @@
+// entropy_scan.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct EntropyScanResult {
+  bool found = false; // 找到真正的 marker
+  size_t pos = 0;     // found: marker 的 0xFF 偏移；否则：可安全跳过的字节数
+};
+
+// 在熵编码数据 [p, p+n) 中查找下一个 marker：
+// 0xFF00 stuffing 与 RSTn 视为数据，连续 0xFF 视为填充。
+// 未找到时末尾的 0xFF 不计入 pos（需要与下一块拼接后再判断）。
+// 运行时按 CPU 选择 AVX2 / SSE2 / 可移植实现
+EntropyScanResult find_entropy_marker(const uint8_t *p, size_t n);
+
+// 当前选用的实现名称（"avx2"/"sse2"/"portable"），便于诊断
+const char *entropy_scan_impl_name();
@@ -1,37 +1,116 @@
 // file_reader.cpp
 #include "file_reader.h"
-#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+FileReader::FileReader(const char *path, size_t block_size)
+    : block_size_(std::max(block_size, kMinBlockSize)) {
+  owned_ = std::make_unique<FileSource>(path);
+  if (owned_->ok())
+    attach(*owned_);
+}
+
+FileReader::FileReader(ByteSource &src, size_t block_size)
+    : block_size_(std::max(block_size, kMinBlockSize)) {
+  attach(src);
+}
 
-FileReader::FileReader(const char *path) { f_ = std::fopen(path, "rb"); }
 FileReader::~FileReader() {
-  if (f_)
-    std::fclose(f_);
+  // 连续数据源不经过 read_at，按访问到的最远位置登记零拷贝读取量
+  if (contiguous_) {
+    note_position();
+    src_->count_view(max_pos_);
+  }
+}
+
+void FileReader::attach(ByteSource &src) {
+  src_ = &src;
+  ByteSpan all = src.contiguous();
+  if (all.data() != nullptr) {
+    contiguous_ = true;
+    base_ = all.data();
+    end_ = all.size();
+  }
 }
-bool FileReader::ok() const { return f_ != nullptr; }
 
 bool FileReader::seek(uint64_t off) {
-#if defined(_WIN32)
-  return _fseeki64(f_, (int64_t)off, SEEK_SET) == 0;
-#else
-  return fseeko(f_, (off_t)off, SEEK_SET) == 0;
-#endif
-}
-uint64_t FileReader::tell() {
-#if defined(_WIN32)
-  return (uint64_t)_ftelli64(f_);
-#else
-  return (uint64_t)ftello(f_);
-#endif
-}
-bool FileReader::read_u8(uint8_t &out) {
-  int c = std::fgetc(f_);
-  if (c == EOF)
+  if (contiguous_) {
+    note_position();
+    if (off > end_)
+      return false;
+    cur_ = (size_t)off;
+    return true;
+  }
+  // 目标仍在缓冲内：只移动游标；否则丢弃缓冲，下次 fill 从新位置读
+  if (off >= buf_pos_ && off <= buf_pos_ + end_) {
+    cur_ = (size_t)(off - buf_pos_);
+    return true;
+  }
+  buf_pos_ = off;
+  cur_ = end_ = 0;
+  return true;
+}
+
+bool FileReader::fill() {
+  if (contiguous_)
     return false;
-  out = (uint8_t)c;
+  if (buf_.size() != block_size_) {
+    buf_.resize(block_size_);
+    base_ = buf_.data();
+  }
+  if (cur_ > 0) {
+    size_t rest = end_ - cur_;
+    std::memmove(buf_.data(), buf_.data() + cur_, rest);
+    buf_pos_ += cur_;
+    cur_ = 0;
+    end_ = rest;
+  }
+  if (end_ == buf_.size())
+    return false;
+  size_t got =
+      src_->read_at(buf_pos_ + end_, buf_.data() + end_, buf_.size() - end_);
+  end_ += got;
+  return got > 0;
+}
+
+bool FileReader::read_u8_slow(uint8_t &out) {
+  if (!fill())
+    return false;
+  out = base_[cur_++];
   return true;
 }
+
 bool FileReader::read_bytes(uint8_t *dst, size_t n) {
-  return std::fread(dst, 1, n, f_) == n;
+  size_t take = std::min(n, available());
+  if (take > 0) {
+    std::memcpy(dst, window(), take);
+    cur_ += take;
+    dst += take;
+    n -= take;
+  }
+  if (n == 0)
+    return true;
+  if (contiguous_)
+    return false;
+
+  // 大块读取绕过缓冲直接读入目标
+  if (n >= block_size_) {
+    uint64_t pos = tell();
+    size_t got = src_->read_at(pos, dst, n);
+    buf_pos_ = pos + got;
+    cur_ = end_ = 0;
+    return got == n;
+  }
+  while (n > 0) {
+    if (!fill())
+      return false;
+    take = std::min(n, available());
+    std::memcpy(dst, window(), take);
+    cur_ += take;
+    dst += take;
+    n -= take;
+  }
+  return true;
 }
 bool FileReader::read_bytes(std::vector<uint8_t> &buf, size_t n) {
   buf.resize(n);
@@ -1,22 +1,72 @@
 // file_reader.h
 #pragma once
+#include "byte_source.h"
 #include <cstdint>
-#include <cstdio>
+#include <memory>
 #include <vector>
 
+// 带内部块缓冲的顺序读取器：小读取走内联快路径，只在缓冲耗尽时访问数据源。
+// 数据源整体在内存中（内存缓冲/映射文件）时，窗口直接指向源数据，不拷贝
 class FileReader {
 public:
-  explicit FileReader(const char *path);
+  static constexpr size_t kDefaultBlockSize = 256 * 1024;
+  static constexpr size_t kMinBlockSize = 4096;
+
+  explicit FileReader(const char *path,
+                      size_t block_size = kDefaultBlockSize);
+  explicit FileReader(ByteSource &src, size_t block_size = kDefaultBlockSize);
   ~FileReader();
-  bool ok() const;
+  FileReader(const FileReader &) = delete;
+  FileReader &operator=(const FileReader &) = delete;
+  bool ok() const { return src_ != nullptr; }
+  size_t block_size() const { return block_size_; }
 
   bool seek(uint64_t off);
-  uint64_t tell();
+  uint64_t tell() const { return buf_pos_ + cur_; }
+  // 数据总长度（不改变读取位置）
+  bool size(uint64_t &out) { return src_->size(out); }
 
-  bool read_u8(uint8_t &out);
+  bool read_u8(uint8_t &out) {
+    if (cur_ < end_) {
+      out = base_[cur_++];
+      return true;
+    }
+    return read_u8_slow(out);
+  }
   bool read_bytes(uint8_t *dst, size_t n);
   bool read_bytes(std::vector<uint8_t> &buf, size_t n);
 
+  // 直接访问缓冲窗口（扫描器用）：window()[0..available()) 为当前位置起的已缓冲数据
+  const uint8_t *window() const { return base_ + cur_; }
+  size_t available() const { return end_ - cur_; }
+  void consume(size_t n) { cur_ += n; }
+  // 保留未消费数据并读入下一块，没有读到新数据时返回 false
+  bool fill();
+  // 确保窗口内至少有 n 字节（n 不超过块大小）
+  bool ensure(size_t n) {
+    while (available() < n) {
+      if (!fill())
+        return false;
+    }
+    return true;
+  }
+
 private:
-  FILE *f_ = nullptr;
+  void attach(ByteSource &src);
+  bool read_u8_slow(uint8_t &out);
+  void note_position() {
+    if (tell() > max_pos_)
+      max_pos_ = tell();
+  }
+
+  std::unique_ptr<FileSource> owned_;
+  ByteSource *src_ = nullptr;
+  bool contiguous_ = false;  // base_ 指向源数据本身
+  size_t block_size_ = kDefaultBlockSize;
+  std::vector<uint8_t> buf_; // 首次 fill 时才分配
+  const uint8_t *base_ = nullptr;
+  uint64_t buf_pos_ = 0; // base_[0] 对应的源偏移
+  size_t cur_ = 0;
+  size_t end_ = 0;
+  uint64_t max_pos_ = 0; // 连续数据源上访问到的最远位置（计入 bytes_viewed）
 };
@@ -2,170 +2,225 @@
 #include "format.h"
 #include "jpeg_markers.h"
 #include "parse_exif.h"
-#include <iomanip>
-#include <sstream>
-
-static std::string format_hex(uint64_t val, int width = 0) {
-  std::ostringstream oss;
-  oss << "0x" << std::hex << std::uppercase;
-  if (width > 0)
-    oss << std::setw(width) << std::setfill('0');
-  oss << val;
-  return oss.str();
-}
+#include "text_writer.h"
+
+// ostream 形式：格式化到临时缓冲后一次写出
+#define JPEGINFO_OSTREAM_OVERLOAD(fn, T)                                       \
+  void fn(std::ostream &os, const T &v, const I18n &i18n) {                    \
+    std::string buf;                                                           \
+    fn(buf, v, i18n);                                                          \
+    os << buf;                                                                 \
+  }
 
-void print_segments(std::ostream &os, const std::vector<SegmentIndex> &segs,
+void print_segments(std::string &out, const std::vector<SegmentIndex> &segs,
                     const I18n &i18n) {
-  os << "\n=== " << i18n.t("segments") << " ===\n";
-  os << std::setw(4) << i18n.t("idx") << " | " << std::setw(6)
-     << i18n.t("marker") << " | " << std::setw(12) << i18n.t("name") << " | "
-     << std::setw(12) << i18n.t("moff") << " | " << std::setw(12)
-     << i18n.t("poff") << " | " << std::setw(10) << i18n.t("plen") << " | "
-     << i18n.t("subtype") << "\n";
-  os << std::string(80, '-') << "\n";
+  TextWriter w(out);
+  w << "\n=== " << i18n.t(Msg::Segments) << " ===\n";
+  w.right(i18n.t(Msg::Idx), 4) << " | ";
+  w.right(i18n.t(Msg::Marker), 6) << " | ";
+  w.right(i18n.t(Msg::Name), 12) << " | ";
+  w.right(i18n.t(Msg::MarkerOff), 12) << " | ";
+  w.right(i18n.t(Msg::PayloadOff), 12) << " | ";
+  w.right(i18n.t(Msg::PayloadLen), 10) << " | " << i18n.t(Msg::Subtype) << "\n";
+  w << std::string_view(
+           "----------------------------------------------------------------"
+           "----------------")
+    << "\n";
 
   for (size_t i = 0; i < segs.size(); i++) {
     const auto &s = segs[i];
-    os << std::setw(4) << i << " | " << std::setw(6) << format_hex(s.marker, 4)
-       << " | " << std::setw(12) << marker_name(s.marker) << " | "
-       << std::setw(12) << s.marker_offset << " | " << std::setw(12)
-       << s.payload_offset << " | " << std::setw(10) << s.payload_len << " | "
-       << s.app_subtype << "\n";
+    w.right(i, 4) << " | 0x";
+    w.hex(s.marker, 4) << " | ";
+    w.right(marker_name(s.marker), 12) << " | ";
+    w.right(s.marker_offset, 12) << " | ";
+    w.right(s.payload_offset, 12) << " | ";
+    w.right(s.payload_len, 10) << " | " << s.app_subtype << "\n";
   }
-  os << "\n";
+  w << "\n";
 }
 
-void print_jfif_info(std::ostream &os, const JfifInfo &jfif, const I18n &i18n) {
-  os << "=== " << i18n.t("jfif") << " ===\n";
+void print_jfif_info(std::string &out, const JfifInfo &jfif, const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Jfif) << " ===\n";
   int major = (jfif.version >> 8) & 0xFF;
   int minor = jfif.version & 0xFF;
-  os << "  Version: " << major << "." << std::setfill('0') << std::setw(2)
-     << minor << "\n";
-  os << "  Units: " << (int)jfif.units;
+  w << "  Version: " << major << ".";
+  w.zero_pad(minor, 2) << "\n";
+  w << "  Units: " << jfif.units;
   if (jfif.units == 0)
-    os << " (no units)";
+    w << " (no units)";
   else if (jfif.units == 1)
-    os << " (dots per inch)";
+    w << " (dots per inch)";
   else if (jfif.units == 2)
-    os << " (dots per cm)";
-  os << "\n";
-  os << "  X-Density: " << jfif.x_density << "\n";
-  os << "  Y-Density: " << jfif.y_density << "\n";
-  os << "  Thumbnail: " << (int)jfif.x_thumb << "x" << (int)jfif.y_thumb
-     << "\n\n";
+    w << " (dots per cm)";
+  w << "\n";
+  w << "  X-Density: " << jfif.x_density << "\n";
+  w << "  Y-Density: " << jfif.y_density << "\n";
+  w << "  Thumbnail: " << jfif.x_thumb << "x" << jfif.y_thumb << "\n\n";
 }
 
-void print_sof_info(std::ostream &os, const SofInfo &sof, const I18n &i18n) {
-  os << "=== " << i18n.t("sof") << " ===\n";
-  os << "  Marker: " << marker_name(sof.marker) << " ("
-     << format_hex(sof.marker, 4) << ")\n";
-  os << "  Precision: " << (int)sof.precision << " bits\n";
-  os << "  Width x Height: " << sof.width << " x " << sof.height << "\n";
-  os << "  Components: " << (int)sof.components << "\n";
+void print_sof_info(std::string &out, const SofInfo &sof, const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Sof) << " ===\n";
+  w << "  Marker: " << marker_name(sof.marker) << " (0x";
+  w.hex(sof.marker, 4) << ")\n";
+  w << "  Precision: " << sof.precision << " bits\n";
+  w << "  Width x Height: " << sof.width << " x " << sof.height << "\n";
+  w << "  Components: " << sof.components << "\n";
   for (size_t i = 0; i < sof.comps.size(); i++) {
     const auto &c = sof.comps[i];
-    os << "    [" << i << "] ID=" << (int)c.id << " H=" << (int)c.h
-       << " V=" << (int)c.v << " QT=" << (int)c.qt << "\n";
+    w << "    [" << i << "] ID=" << c.id << " H=" << c.h << " V=" << c.v
+      << " QT=" << c.qt << "\n";
   }
-  os << "\n";
+  w << "\n";
 }
 
-void print_adobe_info(std::ostream &os, const AdobeInfo &adobe,
+void print_adobe_info(std::string &out, const AdobeInfo &adobe,
                       const I18n &i18n) {
-  os << "=== " << i18n.t("adobe") << " ===\n";
-  os << "  Version: " << adobe.version << "\n";
-  os << "  Flags0: " << format_hex(adobe.flags0, 4) << "\n";
-  os << "  Flags1: " << format_hex(adobe.flags1, 4) << "\n";
-  os << "  Transform: " << (int)adobe.transform;
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Adobe) << " ===\n";
+  w << "  Version: " << adobe.version << "\n";
+  w << "  Flags0: 0x";
+  w.hex(adobe.flags0, 4) << "\n";
+  w << "  Flags1: 0x";
+  w.hex(adobe.flags1, 4) << "\n";
+  w << "  Transform: " << adobe.transform;
   if (adobe.transform == 0)
-    os << " (Unknown)";
+    w << " (Unknown)";
   else if (adobe.transform == 1)
-    os << " (YCbCr)";
+    w << " (YCbCr)";
   else if (adobe.transform == 2)
-    os << " (YCCK)";
-  os << "\n\n";
+    w << " (YCCK)";
+  w << "\n\n";
 }
 
-void print_com_info(std::ostream &os, const ComInfo &com, const I18n &i18n) {
-  os << "=== " << i18n.t("com") << " ===\n";
-  os << "  Length: " << com.len << " bytes\n";
-  os << "  Preview: \"" << com.preview << "\"\n\n";
+void print_com_info(std::string &out, const ComInfo &com, const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Com) << " ===\n";
+  w << "  Length: " << com.len << " bytes\n";
+  w << "  Preview: \"" << com.preview << "\"\n\n";
 }
 
-void print_xmp_info(std::ostream &os, const XmpInfo &xmp, const I18n &i18n) {
-  os << "=== " << i18n.t("xmp") << " ===\n";
-  os << "  " << i18n.t("length_segment") << ": " << xmp.len << " "
-     << i18n.t("bytes") << "\n";
-  os << "  " << i18n.t("length_effective") << ": " << xmp.effective_len << " "
-     << i18n.t("bytes") << "\n";
+void print_xmp_info(std::string &out, const XmpInfo &xmp, const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Xmp) << " ===\n";
+  w << "  " << i18n.t(Msg::LengthSegment) << ": " << xmp.len << " "
+    << i18n.t(Msg::Bytes) << "\n";
+  w << "  " << i18n.t(Msg::LengthEffective) << ": " << xmp.effective_len << " "
+    << i18n.t(Msg::Bytes) << "\n";
   if (xmp.padding_len > 0) {
-    os << "  " << i18n.t("padding") << ": " << xmp.padding_len << " "
-       << i18n.t("bytes") << "\n";
+    w << "  " << i18n.t(Msg::Padding) << ": " << xmp.padding_len << " "
+      << i18n.t(Msg::Bytes) << "\n";
   }
   if (xmp.truncated) {
-    os << "  " << i18n.t("truncated_preview") << "\n";
+    w << "  " << i18n.t(Msg::TruncatedPreview) << "\n";
   }
-  os << "  " << i18n.t("xml") << ":\n" << xmp.xml << "\n\n";
+  w << "  " << i18n.t(Msg::Xml) << ":\n";
+  if (!xmp.properties.empty()) {
+    w << "\n[Extracted Fields]\n";
+    for (const auto &p : xmp.properties) {
+      w << "  " << p.name << ": ";
+      for (size_t i = 0; i < p.values.size(); i++)
+        w << (i ? "; " : "") << p.values[i];
+      w << "\n";
+    }
+    w << "\n[Full XML]\n";
+  }
+  w << xmp.xml << "\n\n";
 }
 
-void print_icc_info(std::ostream &os, const IccProfile &icc, const I18n &i18n) {
-  os << "=== " << i18n.t("icc") << " ===\n";
-  os << "  Total Length: " << icc.total_len << " bytes\n";
+void print_icc_info(std::string &out, const IccProfile &icc, const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Icc) << " ===\n";
+  w << "  Total Length: " << icc.total_len << " bytes\n";
   if (!icc.data.empty()) {
-    os << "  Profile Data: " << icc.data.size() << " bytes loaded\n";
+    w << "  Profile Data: " << icc.data.size() << " bytes loaded\n";
   }
-  os << "\n";
+  w << "\n";
 }
 
-void print_exif_info(std::ostream &os, const ExifResult &exif,
-                     const I18n &i18n) {
-  os << "=== " << i18n.t("exif") << " ===\n";
-  os << "  Endian: " << (exif.endian == Endian::Big ? "Big" : "Little") << "\n";
-
-  if (!exif.ifd0.tags.empty()) {
-    os << "  IFD0 Tags:\n";
-    for (const auto &[tag, entry] : exif.ifd0.tags) {
-      os << "    " << exif_tag_name(tag) << " (0x" << std::hex << std::uppercase
-         << std::setw(4) << std::setfill('0') << tag << std::dec
-         << "): " << entry.value.text << "\n";
-    }
+static const char *thumbnail_kind_name(ThumbnailKind k) {
+  switch (k) {
+  case ThumbnailKind::Exif:
+    return "EXIF JPEG";
+  case ThumbnailKind::JfxxJpeg:
+    return "JFXX JPEG";
+  case ThumbnailKind::JfxxPalette:
+    return "JFXX palette";
+  case ThumbnailKind::JfxxRgb:
+    return "JFXX RGB";
   }
+  return "?";
+}
 
-  if (!exif.exif_ifd.tags.empty()) {
-    os << "  EXIF IFD Tags:\n";
-    for (const auto &[tag, entry] : exif.exif_ifd.tags) {
-      os << "    " << exif_tag_name(tag) << " (0x" << std::hex << std::uppercase
-         << std::setw(4) << std::setfill('0') << tag << std::dec
-         << "): " << entry.value.text << "\n";
-    }
+void print_thumbnail_info(std::string &out,
+                          const std::vector<ThumbnailInfo> &thumbs,
+                          const I18n &i18n) {
+  if (thumbs.empty())
+    return;
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Thumbnails) << " ===\n";
+  for (const auto &t : thumbs) {
+    w << "  " << thumbnail_kind_name(t.kind);
+    if (t.width && t.height)
+      w << " " << t.width << "x" << t.height;
+    w << ": offset " << t.offset << ", " << t.length << " " << i18n.t(Msg::Bytes)
+      << "\n";
   }
+  w << "\n";
+}
 
-  if (!exif.gps_ifd.tags.empty()) {
-    os << "  GPS IFD Tags:\n";
-    for (const auto &[tag, entry] : exif.gps_ifd.tags) {
-      os << "    " << exif_tag_name(tag) << " (0x" << std::hex << std::uppercase
-         << std::setw(4) << std::setfill('0') << tag << std::dec
-         << "): " << entry.value.text << "\n";
-    }
+static void print_ifd_tags(TextWriter &w, const ExifResult &exif,
+                           const ExifIfd &ifd, const char *title) {
+  if (ifd.tags.empty())
+    return;
+  w << "  " << title << ":\n";
+  for (const auto &entry : ifd.tags) {
+    w << "    " << exif_tag_name(entry.tag, ifd.ns) << " (0x";
+    w.hex(entry.tag, 4) << "): ";
+    format_exif_value(w.str(), exif, ifd, entry);
+    w << "\n";
   }
+}
 
-  if (exif.latitude.has_value() || exif.longitude.has_value()) {
-    os << "\n=== " << i18n.t("gps") << " ===\n";
+static void print_gps_coord(TextWriter &w, const char *label,
+                            const std::optional<GpsCoord> &c) {
+  w << "  " << label << ": ";
+  if (c.has_value() && c->valid)
+    w.fixed(c->deg, 6) << "°\n";
+  else
+    w << "not available\n";
+}
 
-    if (exif.latitude.has_value() && exif.latitude->valid) {
-      os << "  Latitude: " << std::fixed << std::setprecision(6)
-         << exif.latitude->deg << "°\n";
-    } else {
-      os << "  Latitude: not available\n";
-    }
+void print_exif_info(std::string &out, const ExifResult &exif,
+                     const I18n &i18n) {
+  TextWriter w(out);
+  w << "=== " << i18n.t(Msg::Exif) << " ===\n";
+  w << "  Endian: " << (exif.endian == Endian::Big ? "Big" : "Little") << "\n";
+
+  print_ifd_tags(w, exif, exif.ifd0, "IFD0 Tags");
+  print_ifd_tags(w, exif, exif.exif_ifd, "EXIF IFD Tags");
+  print_ifd_tags(w, exif, exif.gps_ifd, "GPS IFD Tags");
+  print_ifd_tags(w, exif, exif.interop_ifd, "Interop IFD Tags");
+  print_ifd_tags(w, exif, exif.ifd1, "IFD1 Tags");
+  if (exif.truncated)
+    w << "  (IFD walk stopped early: cyclic offsets or size limits)\n";
 
-    if (exif.longitude.has_value() && exif.longitude->valid) {
-      os << "  Longitude: " << std::fixed << std::setprecision(6)
-         << exif.longitude->deg << "°\n";
-    } else {
-      os << "  Longitude: not available\n";
-    }
+  if (exif.latitude.has_value() || exif.longitude.has_value()) {
+    w << "\n=== " << i18n.t(Msg::Gps) << " ===\n";
+    print_gps_coord(w, "Latitude", exif.latitude);
+    print_gps_coord(w, "Longitude", exif.longitude);
   }
 
-  os << "\n";
+  w << "\n";
 }
+
+JPEGINFO_OSTREAM_OVERLOAD(print_segments, std::vector<SegmentIndex>)
+JPEGINFO_OSTREAM_OVERLOAD(print_jfif_info, JfifInfo)
+JPEGINFO_OSTREAM_OVERLOAD(print_sof_info, SofInfo)
+JPEGINFO_OSTREAM_OVERLOAD(print_adobe_info, AdobeInfo)
+JPEGINFO_OSTREAM_OVERLOAD(print_com_info, ComInfo)
+JPEGINFO_OSTREAM_OVERLOAD(print_xmp_info, XmpInfo)
+JPEGINFO_OSTREAM_OVERLOAD(print_icc_info, IccProfile)
+JPEGINFO_OSTREAM_OVERLOAD(print_exif_info, ExifResult)
+JPEGINFO_OSTREAM_OVERLOAD(print_thumbnail_info, std::vector<ThumbnailInfo>)
@@ -6,29 +6,51 @@
 #include <string>
 #include <vector>
 
+// 每个 print_* 都有两种形式：追加到调用方可复用的 std::string（批量输出走这条路，
+// 不经过 iostream），或写入 std::ostream（内部先格式化到临时缓冲再一次写出）
+
 // 格式化输出分区列表
+void print_segments(std::string &out, const std::vector<SegmentIndex> &segs,
+                    const I18n &i18n);
 void print_segments(std::ostream &os, const std::vector<SegmentIndex> &segs,
                     const I18n &i18n);
 
 // 格式化输出JFIF信息
+void print_jfif_info(std::string &out, const JfifInfo &jfif, const I18n &i18n);
 void print_jfif_info(std::ostream &os, const JfifInfo &jfif, const I18n &i18n);
 
 // 格式化输出SOF信息
+void print_sof_info(std::string &out, const SofInfo &sof, const I18n &i18n);
 void print_sof_info(std::ostream &os, const SofInfo &sof, const I18n &i18n);
 
 // 格式化输出Adobe信息
+void print_adobe_info(std::string &out, const AdobeInfo &adobe,
+                      const I18n &i18n);
 void print_adobe_info(std::ostream &os, const AdobeInfo &adobe,
                       const I18n &i18n);
 
 // 格式化输出COM信息
+void print_com_info(std::string &out, const ComInfo &com, const I18n &i18n);
 void print_com_info(std::ostream &os, const ComInfo &com, const I18n &i18n);
 
 // 格式化输出XMP信息
+void print_xmp_info(std::string &out, const XmpInfo &xmp, const I18n &i18n);
 void print_xmp_info(std::ostream &os, const XmpInfo &xmp, const I18n &i18n);
 
 // 格式化输出ICC Profile信息
+void print_icc_info(std::string &out, const IccProfile &icc, const I18n &i18n);
 void print_icc_info(std::ostream &os, const IccProfile &icc, const I18n &i18n);
 
 // 格式化输出EXIF信息
+void print_exif_info(std::string &out, const ExifResult &exif,
+                     const I18n &i18n);
 void print_exif_info(std::ostream &os, const ExifResult &exif,
                      const I18n &i18n);
+
+// 格式化输出缩略图位置
+void print_thumbnail_info(std::string &out,
+                          const std::vector<ThumbnailInfo> &thumbs,
+                          const I18n &i18n);
+void print_thumbnail_info(std::ostream &os,
+                          const std::vector<ThumbnailInfo> &thumbs,
+                          const I18n &i18n);
@@ -0,0 +1,378 @@
+// format_json.cpp
+#include "format_json.h"
+#include "jpeg_markers.h"
+#include "text_writer.h"
+#include <algorithm>
+
+// 格式化用的临时文本，每个字段写出前清空，容量在整个对象内复用
+static std::string_view hex16(std::string &scratch, uint16_t v) {
+  scratch.clear();
+  TextWriter t(scratch);
+  (t << "0x").hex(v, 4);
+  return scratch;
+}
+
+static const char *tiff_type_name(uint16_t t) {
+  switch (t) {
+  case 1:
+    return "BYTE";
+  case 2:
+    return "ASCII";
+  case 3:
+    return "SHORT";
+  case 4:
+    return "LONG";
+  case 5:
+    return "RATIONAL";
+  case 6:
+    return "SBYTE";
+  case 7:
+    return "UNDEFINED";
+  case 8:
+    return "SSHORT";
+  case 9:
+    return "SLONG";
+  case 10:
+    return "SRATIONAL";
+  case 11:
+    return "FLOAT";
+  case 12:
+    return "DOUBLE";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+static const char *thumbnail_kind_id(ThumbnailKind k) {
+  switch (k) {
+  case ThumbnailKind::Exif:
+    return "exif";
+  case ThumbnailKind::JfxxJpeg:
+    return "jfxx_jpeg";
+  case ThumbnailKind::JfxxPalette:
+    return "jfxx_palette";
+  case ThumbnailKind::JfxxRgb:
+    return "jfxx_rgb";
+  }
+  return "unknown";
+}
+
+// 第 i 个元素；RATIONAL/SRATIONAL 输出 [分子, 分母]
+template <Endian E>
+static void write_exif_element(JsonWriter &w, uint16_t type,
+                               const ExifTypedValues<E> &v, size_t i) {
+  switch (type) {
+  case 1:
+    w.value(v.bytes()[i]);
+    break;
+  case 3:
+    w.value(v.u16(i));
+    break;
+  case 4:
+    w.value(v.u32(i));
+    break;
+  case 6:
+    w.value(v.s8(i));
+    break;
+  case 8:
+    w.value(v.s16(i));
+    break;
+  case 9:
+    w.value(v.s32(i));
+    break;
+  case 11:
+    w.value((double)v.f32(i));
+    break;
+  case 12:
+    w.value(v.f64(i));
+    break;
+  case 5: {
+    ExifRational r = v.rational(i);
+    w.begin_array().value(r.num).value(r.den).end_array();
+    break;
+  }
+  case 10: {
+    ExifSRational r = v.srational(i);
+    w.begin_array().value(r.num).value(r.den).end_array();
+    break;
+  }
+  default:
+    w.null();
+  }
+}
+
+// value 最多输出的元素数，与文本输出的预览长度一致：
+// 字节类（含 UNDEFINED 的十六进制）16 个，有理数 4 个，其他数值 8 个
+static uint32_t json_value_limit(uint16_t type) {
+  switch (type) {
+  case 1:
+  case 6:
+  case 7:
+    return 16;
+  case 5:
+  case 10:
+    return 4;
+  default:
+    return 8;
+  }
+}
+
+// 类型化的值：ASCII 为字符串，UNDEFINED 为十六进制字符串，
+// 数值类型 count==1 时为单个值、否则为数组；无法解码时为 null。
+// 超过 json_value_limit 的部分不输出（MakerNote 等大块数据），此时返回 true
+static bool write_exif_value(JsonWriter &w, const ExifValueView &v) {
+  if (!v.valid()) {
+    w.null();
+    return false;
+  }
+  if (v.type() == 2) {
+    w.value(v.ascii());
+    return false;
+  }
+  const uint32_t n = std::min(v.count(), json_value_limit(v.type()));
+  if (v.type() == 7) {
+    static const char kHex[] = "0123456789abcdef";
+    char hex[32];
+    for (uint32_t i = 0; i < n; i++) {
+      hex[i * 2] = kHex[v.bytes()[i] >> 4];
+      hex[i * 2 + 1] = kHex[v.bytes()[i] & 0xF];
+    }
+    w.value(std::string_view(hex, (size_t)n * 2));
+    return n < v.count();
+  }
+  // 字节序只分派一次，元素循环在编译期确定字节序的视图上读取
+  v.visit([&](const auto &t) {
+    if (v.count() == 1) {
+      write_exif_element(w, v.type(), t, 0);
+      return;
+    }
+    w.begin_array();
+    for (size_t i = 0; i < n; i++)
+      write_exif_element(w, v.type(), t, i);
+    w.end_array();
+  });
+  return v.count() > 1 && n < v.count();
+}
+
+static void write_ifd(JsonWriter &w, const ExifResult &exif,
+                      const ExifIfd &ifd, const char *name,
+                      std::string &scratch) {
+  w.key(name).begin_array();
+  for (const auto &entry : ifd.tags) {
+    w.begin_object();
+    w.field("tag", entry.tag);
+    std::string_view tag_name = exif_tag_name(entry.tag, ifd.ns);
+    w.key("name");
+    if (tag_name.empty())
+      w.null();
+    else
+      w.value(tag_name);
+    w.field("type", tiff_type_name(entry.type));
+    w.field("count", entry.count);
+    w.key("value");
+    if (write_exif_value(w, exif_value(exif, entry)))
+      w.field("truncated", true);
+    scratch.clear();
+    format_exif_value(scratch, exif, ifd, entry);
+    w.field("text", std::string_view(scratch));
+    w.end_object();
+  }
+  w.end_array();
+}
+
+static void write_gps_coord(JsonWriter &w, const char *name,
+                            const std::optional<GpsCoord> &c) {
+  w.key(name);
+  if (c.has_value() && c->valid)
+    w.value(c->deg);
+  else
+    w.null();
+}
+
+static void write_exif(JsonWriter &w, const ExifResult &exif,
+                       std::string &scratch) {
+  w.begin_object();
+  w.field("byte_order", exif.endian == Endian::Big ? "big" : "little");
+  write_ifd(w, exif, exif.ifd0, "ifd0", scratch);
+  write_ifd(w, exif, exif.exif_ifd, "exif", scratch);
+  write_ifd(w, exif, exif.gps_ifd, "gps", scratch);
+  write_ifd(w, exif, exif.interop_ifd, "interop", scratch);
+  write_ifd(w, exif, exif.ifd1, "ifd1", scratch);
+  w.field("truncated", exif.truncated);
+  w.key("gps_position");
+  if (exif.latitude.has_value() || exif.longitude.has_value()) {
+    w.begin_object();
+    write_gps_coord(w, "latitude", exif.latitude);
+    write_gps_coord(w, "longitude", exif.longitude);
+    w.end_object();
+  } else {
+    w.null();
+  }
+  w.end_object();
+}
+
+void write_jpeg_json(JsonWriter &w, const std::string &path,
+                     const JpegInfo &info, const JsonSections &sel) {
+  std::string scratch;
+  w.begin_object();
+  w.field("file", path);
+
+  if (sel.segments) {
+    w.key("segments").begin_array();
+    for (const auto &s : info.index.segments) {
+      w.begin_object();
+      w.field("marker", hex16(scratch, s.marker));
+      w.field("name", marker_name(s.marker));
+      w.field("offset", s.marker_offset);
+      w.field("payload_offset", s.payload_offset);
+      w.field("payload_length", s.payload_len);
+      w.field("subtype", s.app_subtype);
+      w.end_object();
+    }
+    w.end_array();
+    w.field("scan_skipped", info.index.scan_skipped);
+    w.field("eoi_probed", info.index.eoi_probed);
+    w.key("trailing_bytes");
+    if (info.index.trailing_bytes.has_value())
+      w.value(*info.index.trailing_bytes);
+    else
+      w.null();
+  }
+
+  if (sel.jfif) {
+    w.key("jfif").begin_array();
+    for (const auto &j : info.jfif) {
+      scratch.clear();
+      TextWriter t(scratch);
+      (t << ((j.version >> 8) & 0xFF) << '.').zero_pad(j.version & 0xFF, 2);
+      w.begin_object();
+      w.field("version", std::string_view(scratch));
+      w.field("units", j.units);
+      w.field("x_density", j.x_density);
+      w.field("y_density", j.y_density);
+      w.field("thumbnail_width", j.x_thumb);
+      w.field("thumbnail_height", j.y_thumb);
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  if (sel.sof) {
+    w.key("sof").begin_array();
+    for (const auto &s : info.sof) {
+      w.begin_object();
+      w.field("marker", hex16(scratch, s.marker));
+      w.field("name", marker_name(s.marker));
+      w.field("precision", s.precision);
+      w.field("width", s.width);
+      w.field("height", s.height);
+      w.key("components").begin_array();
+      for (const auto &c : s.comps) {
+        w.begin_object();
+        w.field("id", c.id);
+        w.field("h", c.h);
+        w.field("v", c.v);
+        w.field("qt", c.qt);
+        w.end_object();
+      }
+      w.end_array();
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  if (sel.exif) {
+    w.key("exif").begin_array();
+    for (const auto &e : info.exif)
+      write_exif(w, e, scratch);
+    w.end_array();
+  }
+
+  if (sel.xmp) {
+    w.key("xmp").begin_array();
+    for (const auto &x : info.xmp) {
+      w.begin_object();
+      w.field("length", x.len);
+      w.field("effective_length", x.effective_len);
+      w.field("padding_length", x.padding_len);
+      w.field("truncated", x.truncated);
+      // 单值属性为字符串，rdf:Alt/Seq/Bag 为字符串数组
+      w.key("properties").begin_object();
+      for (const auto &p : x.properties) {
+        w.key(p.name);
+        if (p.form == XmpValueForm::Simple) {
+          w.value(p.values.front());
+          continue;
+        }
+        w.begin_array();
+        for (const auto &v : p.values)
+          w.value(v);
+        w.end_array();
+      }
+      w.end_object();
+      w.field("xml", x.xml);
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  if (sel.icc) {
+    w.key("icc");
+    if (info.icc.has_value()) {
+      w.begin_object();
+      w.field("length", info.icc->total_len);
+      w.field("loaded", info.icc->data.size());
+      w.end_object();
+    } else {
+      w.null();
+    }
+  }
+
+  if (sel.adobe) {
+    w.key("adobe").begin_array();
+    for (const auto &a : info.adobe) {
+      w.begin_object();
+      w.field("version", a.version);
+      w.field("flags0", a.flags0);
+      w.field("flags1", a.flags1);
+      w.field("transform", a.transform);
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  if (sel.com) {
+    w.key("com").begin_array();
+    for (const auto &c : info.com) {
+      w.begin_object();
+      w.field("length", c.len);
+      w.field("text", c.preview);
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  if (sel.thumbnails) {
+    w.key("thumbnails").begin_array();
+    for (const auto &t : info.thumbnails) {
+      w.begin_object();
+      w.field("kind", thumbnail_kind_id(t.kind));
+      w.field("offset", t.offset);
+      w.field("length", t.length);
+      w.field("width", t.width);
+      w.field("height", t.height);
+      w.end_object();
+    }
+    w.end_array();
+  }
+
+  w.end_object();
+}
+
+void write_error_json(JsonWriter &w, const std::string &path,
+                      const char *error) {
+  w.begin_object();
+  w.field("file", path);
+  w.field("error", error);
+  w.end_object();
+}
@@ -0,0 +1,28 @@
+// format_json.h
+#pragma once
+#include "jpeginfo.h"
+#include "json_writer.h"
+#include <string>
+
+// 需要输出的部分；未选中的部分不出现在对象中
+struct JsonSections {
+  bool segments = true;
+  bool jfif = true;
+  bool sof = true;
+  bool exif = true; // 含 GPS
+  bool xmp = true;
+  bool icc = true;
+  bool adobe = true;
+  bool com = true;
+  bool thumbnails = true;
+};
+
+// 一个文件的分析结果写成一个 JSON 对象（--format=json/ndjson）。
+// 字段名固定、与界面语言无关；EXIF 值按 TIFF 类型输出为数字/字符串/数组，
+// 另附与文本输出相同的可读文本 "text"
+void write_jpeg_json(JsonWriter &w, const std::string &path,
+                     const JpegInfo &info, const JsonSections &sel);
+
+// 分析失败的文件：{"file": ..., "error": ...}
+void write_error_json(JsonWriter &w, const std::string &path,
+                      const char *error);
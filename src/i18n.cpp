@@ -1,63 +1,63 @@
 // i18n.cpp
 #include "i18n.h"
-#include <unordered_map>
 
-static const std::unordered_map<std::string, std::string> ZH = {
-    {"segments", "分区列表"},
-    {"idx", "索引"},
-    {"marker", "标记"},
-    {"name", "名称"},
-    {"moff", "标记偏移"},
-    {"poff", "载荷偏移"},
-    {"plen", "载荷长度"},
-    {"subtype", "APP子类型"},
-    {"jfif", "JFIF信息"},
-    {"sof", "图像基本信息(SOF)"},
-    {"exif", "EXIF信息"},
-    {"gps", "GPS信息"},
-    {"xmp", "XMP信息"},
-    {"icc", "ICC Profile信息"},
-    {"adobe", "Adobe(APP14)信息"},
-    {"com", "注释(COM)"},
-    {"error_parse", "解析失败"},
-    {"length_segment", "长度(段)"},
-    {"length_effective", "长度(有效内容)"},
-    {"padding", "填充"},
-    {"truncated_preview", "(截断预览)"},
-    {"xml", "XML"},
-    {"bytes", "字节"},
+namespace {
+
+struct MessageText {
+  Msg id;
+  std::string_view zh;
+  std::string_view en;
 };
 
-static const std::unordered_map<std::string, std::string> EN = {
-    {"segments", "Segments"},
-    {"idx", "Idx"},
-    {"marker", "Marker"},
-    {"name", "Name"},
-    {"moff", "MarkerOff"},
-    {"poff", "PayloadOff"},
-    {"plen", "PayloadLen"},
-    {"subtype", "Subtype"},
-    {"jfif", "JFIF"},
-    {"sof", "SOF"},
-    {"exif", "EXIF"},
-    {"gps", "GPS"},
-    {"xmp", "XMP"},
-    {"icc", "ICC Profile"},
-    {"adobe", "Adobe(APP14)"},
-    {"com", "COM"},
-    {"error_parse", "Parse failed"},
-    {"length_segment", "Length (segment)"},
-    {"length_effective", "Length (effective XML)"},
-    {"padding", "Padding"},
-    {"truncated_preview", "(Truncated preview)"},
-    {"xml", "XML"},
-    {"bytes", "bytes"},
+// 按 Msg 的顺序排列，编译期校验
+constexpr MessageText kMessages[] = {
+    {Msg::Segments, "分区列表", "Segments"},
+    {Msg::Idx, "索引", "Idx"},
+    {Msg::Marker, "标记", "Marker"},
+    {Msg::Name, "名称", "Name"},
+    {Msg::MarkerOff, "标记偏移", "MarkerOff"},
+    {Msg::PayloadOff, "载荷偏移", "PayloadOff"},
+    {Msg::PayloadLen, "载荷长度", "PayloadLen"},
+    {Msg::Subtype, "APP子类型", "Subtype"},
+    {Msg::Jfif, "JFIF信息", "JFIF"},
+    {Msg::Sof, "图像基本信息(SOF)", "SOF"},
+    {Msg::Exif, "EXIF信息", "EXIF"},
+    {Msg::Gps, "GPS信息", "GPS"},
+    {Msg::Xmp, "XMP信息", "XMP"},
+    {Msg::Icc, "ICC Profile信息", "ICC Profile"},
+    {Msg::Adobe, "Adobe(APP14)信息", "Adobe(APP14)"},
+    {Msg::Com, "注释(COM)", "COM"},
+    {Msg::Thumbnails, "缩略图", "Thumbnails"},
+    {Msg::ErrorWrite, "写入失败", "Write failed"},
+    {Msg::ErrorParse, "解析失败", "Parse failed"},
+    {Msg::LengthSegment, "长度(段)", "Length (segment)"},
+    {Msg::LengthEffective, "长度(有效内容)", "Length (effective XML)"},
+    {Msg::Padding, "填充", "Padding"},
+    {Msg::TruncatedPreview, "(截断预览)", "(Truncated preview)"},
+    {Msg::Xml, "XML", "XML"},
+    {Msg::Bytes, "字节", "bytes"},
+    {Msg::UnknownExifTag, "未知的 EXIF tag", "unknown EXIF tag"},
+    {Msg::UnknownXmpProperty, "未知的 XMP 属性", "unknown XMP property"},
+    {Msg::UnknownOption, "未知选项", "unknown option"},
+    {Msg::ErrorListFile, "无法打开列表文件", "cannot open list file"},
+    {Msg::ErrorColumnarTags, "--format=columnar 的列固定，不能与 --tags 一起使用",
+     "--tags cannot be combined with --format=columnar (its columns are fixed)"},
 };
 
-std::string I18n::t(const std::string &key) const {
-  const auto &m = (lang == Lang::ZH) ? ZH : EN;
-  auto it = m.find(key);
-  if (it != m.end())
-    return it->second;
-  return key;
+static_assert(sizeof(kMessages) / sizeof(kMessages[0]) == (size_t)Msg::Count,
+              "message table out of sync with Msg");
+
+constexpr bool messages_in_order() {
+  for (size_t i = 0; i < (size_t)Msg::Count; i++)
+    if ((size_t)kMessages[i].id != i)
+      return false;
+  return true;
+}
+static_assert(messages_in_order(), "message table must follow Msg order");
+
+} // namespace
+
+std::string_view I18n::t(Msg id) const {
+  const MessageText &m = kMessages[(size_t)id];
+  return lang == Lang::ZH ? m.zh : m.en;
 }
@@ -1,10 +1,46 @@
 // i18n.h
 #pragma once
-#include <string>
+#include <cstdint>
+#include <string_view>
 
 enum class Lang { EN, ZH };
 
+// 界面文本编号；查表即数组下标，翻译表是编译期常量，不需要启动时初始化
+enum class Msg : uint8_t {
+  Segments,
+  Idx,
+  Marker,
+  Name,
+  MarkerOff,
+  PayloadOff,
+  PayloadLen,
+  Subtype,
+  Jfif,
+  Sof,
+  Exif,
+  Gps,
+  Xmp,
+  Icc,
+  Adobe,
+  Com,
+  Thumbnails,
+  ErrorWrite,
+  ErrorParse,
+  LengthSegment,
+  LengthEffective,
+  Padding,
+  TruncatedPreview,
+  Xml,
+  Bytes,
+  UnknownExifTag,
+  UnknownXmpProperty,
+  UnknownOption,
+  ErrorListFile,
+  ErrorColumnarTags,
+  Count,
+};
+
 struct I18n {
   Lang lang = Lang::ZH;
-  std::string t(const std::string &key) const;
+  std::string_view t(Msg id) const;
 };
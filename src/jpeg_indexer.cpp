@@ -1,5 +1,6 @@
 // jpeg_indexer.cpp
 #include "jpeg_indexer.h"
+#include "entropy_scan.h"
 #include "file_reader.h"
 #include "jpeg_markers.h"
 #include <algorithm>
@@ -25,38 +26,47 @@ static bool read_marker(FileReader &r, uint16_t &out_marker) {
   return true;
 }
 
-// SOS之后跳过scan data直到下一个marker（处理0xFF00 stuffing）
+// SOS之后跳过scan data直到下一个marker（处理0xFF00 stuffing、RSTn 与填充字节）
+// 在 FileReader 的缓冲窗口上运行向量化扫描，不逐字节调用 libc
 static bool skip_scan_data_to_next_marker(FileReader &r) {
   while (true) {
-    uint8_t b = 0;
-    if (!r.read_u8(b))
-      return false;
-    if (b != 0xFF)
-      continue;
-
-    uint64_t ff_pos = r.tell() - 1;
-    uint8_t c = 0;
-    if (!r.read_u8(c))
+    if (!r.ensure(2))
       return false;
+    EntropyScanResult res = find_entropy_marker(r.window(), r.available());
+    r.consume(res.pos);
+    if (res.found)
+      return true; // 停在 marker 的 0xFF 上
+  }
+}
 
-    if (c == 0x00)
-      continue; // stuffed
-    if (c == 0xFF) {
-      while (c == 0xFF) {
-        if (!r.read_u8(c))
-          return false;
-      }
-      if (c == 0x00)
-        continue;
+// 从文件尾部反向查找 EOI：最后一个 0xFFD9 之后的内容视为尾随数据。
+// 尾随数据本身含 0xFFD9（如拼接的第二张 JPEG）时结果只是近似
+static bool probe_eoi_from_tail(FileReader &r, uint64_t scan_start,
+                                size_t probe_bytes, JpegIndexResult &out) {
+  uint64_t fsize = 0;
+  if (!r.size(fsize) || fsize < scan_start + 2)
+    return false;
+  uint64_t take = std::min<uint64_t>(probe_bytes, fsize - scan_start);
+  if (take < 2) // 不足一个 marker（如 tail_probe_bytes 为 0）
+    return false;
+  std::vector<uint8_t> tail;
+  if (!r.seek(fsize - take) || !r.read_bytes(tail, (size_t)take))
+    return false;
+  for (size_t i = tail.size() - 1; i > 0; i--) {
+    if (tail[i - 1] == 0xFF && tail[i] == 0xD9) {
+      SegmentIndex eoi_seg;
+      eoi_seg.marker = 0xFFD9;
+      eoi_seg.marker_offset = fsize - take + (i - 1);
+      out.segments.push_back(eoi_seg);
+      out.eoi_probed = true;
+      out.trailing_bytes = fsize - (eoi_seg.marker_offset + 2);
+      return true;
     }
-
-    // found marker, rewind
-    return r.seek(ff_pos);
   }
+  return false;
 }
 
-static std::string detect_app_subtype(uint16_t marker,
-                                      const std::vector<uint8_t> &head) {
+static std::string detect_app_subtype(uint16_t marker, ByteSpan head) {
   if (marker == 0xFFE0) { // APP0
     if (head.size() >= 5 && std::memcmp(head.data(), "JFIF\0", 5) == 0)
       return "JFIF";
@@ -84,12 +94,33 @@ static std::string detect_app_subtype(uint16_t marker,
   return "Unknown";
 }
 
-JpegIndexResult build_jpeg_index(const std::string &path,
-                                 const IndexOptions &opt) {
+// 把当前位置起的段 payload 交给 sink 并越过它：放得进缓冲窗口时直接给视图，
+// 否则读入 scratch（只有超过块大小的段才需要）
+static bool deliver_payload(FileReader &r, const SegmentIndex &seg,
+                            SegmentSink &sink, std::vector<uint8_t> &scratch) {
+  if (seg.payload_len <= r.block_size()) {
+    if (!r.ensure(seg.payload_len))
+      return false;
+    sink.on_payload(seg, ByteSpan(r.window(), seg.payload_len));
+    r.consume(seg.payload_len);
+    return true;
+  }
+  if (!r.read_bytes(scratch, seg.payload_len))
+    return false;
+  sink.on_payload(seg, ByteSpan(scratch));
+  return true;
+}
+
+JpegIndexResult build_jpeg_index(ByteSource &src, const IndexOptions &opt,
+                                 SegmentSink *sink) {
   JpegIndexResult out;
-  FileReader r(path.c_str());
-  if (!r.ok())
-    return out;
+  // 只读头部时用小块，避免第一次填充就读入大量压缩数据
+  size_t block = opt.stop_at_sos ? std::min<size_t>(opt.io_block_size, 16384)
+                                 : opt.io_block_size;
+  // 按请求计费的数据源上一次读够，跳过大段时也多半落在同一块内
+  block = std::max(block, src.preferred_read_size());
+  FileReader r(src, block);
+  std::vector<uint8_t> scratch;
 
   uint8_t soi[2] = {0};
   if (!r.read_bytes(soi, 2))
@@ -132,12 +163,16 @@ JpegIndexResult build_jpeg_index(const std::string &path,
 
     // APP peek for subtype
     if (marker >= 0xFFE0 && marker <= 0xFFEF) {
-      size_t peek = std::min<size_t>(opt.app_peek_bytes, seg.payload_len);
-      std::vector<uint8_t> head;
-      if (!r.read_bytes(head, peek))
+      // 直接在缓冲窗口里窥视前缀，不额外分配
+      size_t peek = std::min<size_t>(
+          {opt.app_peek_bytes, seg.payload_len, FileReader::kMinBlockSize});
+      if (!r.ensure(peek))
+        break;
+      seg.app_subtype = detect_app_subtype(marker, ByteSpan(r.window(), peek));
+      if (sink && sink->want(seg) && !deliver_payload(r, seg, *sink, scratch))
+        break;
+      if (!r.seek(seg.payload_offset + seg.payload_len))
         break;
-      seg.app_subtype = detect_app_subtype(marker, head);
-      r.seek(seg.payload_offset + seg.payload_len);
       out.segments.push_back(seg);
       continue;
     }
@@ -145,6 +180,13 @@ JpegIndexResult build_jpeg_index(const std::string &path,
     // SOS: 跳过压缩数据到 EOI
     if (marker == 0xFFDA) {
       out.segments.push_back(seg);
+      if (opt.stop_at_sos) {
+        out.scan_skipped = true;
+        if (opt.probe_tail)
+          probe_eoi_from_tail(r, seg.payload_offset + seg.payload_len,
+                              opt.tail_probe_bytes, out);
+        break;
+      }
       if (!r.seek(seg.payload_offset + seg.payload_len))
         break;
       if (!skip_scan_data_to_next_marker(r))
@@ -158,11 +200,16 @@ JpegIndexResult build_jpeg_index(const std::string &path,
         eoi_seg.marker = 0xFFD9;
         eoi_seg.marker_offset = eoi_off;
         out.segments.push_back(eoi_seg);
+        uint64_t fsize = 0;
+        if (r.size(fsize) && fsize >= eoi_off + 2)
+          out.trailing_bytes = fsize - (eoi_off + 2);
       }
       break;
     }
 
     // default skip
+    if (sink && sink->want(seg) && !deliver_payload(r, seg, *sink, scratch))
+      break;
     if (!r.seek(seg.payload_offset + seg.payload_len))
       break;
     out.segments.push_back(seg);
@@ -171,12 +218,49 @@ JpegIndexResult build_jpeg_index(const std::string &path,
   return out;
 }
 
+JpegIndexResult build_jpeg_index(const std::string &path,
+                                 const IndexOptions &opt) {
+  FileSource src(path.c_str());
+  if (!src.ok())
+    return JpegIndexResult();
+  return build_jpeg_index(src, opt);
+}
+
+JpegIndexResult build_jpeg_index(const uint8_t *data, size_t len,
+                                 const IndexOptions &opt) {
+  MemorySource src(data, len);
+  return build_jpeg_index(src, opt);
+}
+
 bool load_segment_payload(const std::string &path, const SegmentIndex &seg,
                           std::vector<uint8_t> &out) {
-  FileReader r(path.c_str());
-  if (!r.ok())
+  FileSource src(path.c_str());
+  if (!src.ok())
     return false;
-  if (!r.seek(seg.payload_offset))
+  out.resize(seg.payload_len);
+  return src.read_at(seg.payload_offset, out.data(), out.size()) == out.size();
+}
+
+bool segment_payload(ByteSource &src, const SegmentIndex &seg,
+                     std::vector<uint8_t> &storage, ByteSpan &out) {
+  ByteSpan all = src.contiguous();
+  if (all.data() != nullptr) {
+    if (seg.payload_offset > all.size() ||
+        seg.payload_len > all.size() - seg.payload_offset)
+      return false;
+    out = ByteSpan(all.data() + seg.payload_offset, seg.payload_len);
+    src.count_view(seg.payload_len);
+    return true;
+  }
+  storage.resize(seg.payload_len);
+  if (src.read_at(seg.payload_offset, storage.data(), storage.size()) !=
+      storage.size())
     return false;
-  return r.read_bytes(out, seg.payload_len);
+  out = ByteSpan(storage);
+  return true;
+}
+
+bool segment_payload(const MappedFile &file, const SegmentIndex &seg,
+                     ByteSpan &out) {
+  return file.slice(seg.payload_offset, seg.payload_len, out);
 }
@@ -1,18 +1,52 @@
 // jpeg_indexer.h
 #pragma once
+#include "byte_source.h"
 #include "jpeg_types.h"
+#include "mapped_file.h"
 #include <string>
 #include <vector>
 
 struct IndexOptions {
   size_t app_peek_bytes = 64; // 识别APP subtype只读前缀
+  size_t io_block_size = 256 * 1024; // FileReader 块缓冲大小（建议 64KiB~1MiB）
+
+  // 只索引元数据：遇到第一个 SOS 即停止，不读取熵编码数据
+  bool stop_at_sos = false;
+  // stop_at_sos 时读取文件末尾 tail_probe_bytes 字节定位 EOI/尾随数据
+  bool probe_tail = false;
+  size_t tail_probe_bytes = 4096;
 };
 
 struct JpegIndexResult {
   std::vector<SegmentIndex> segments;
+  bool scan_skipped = false; // stop_at_sos 生效，未扫描熵编码数据
+  bool eoi_probed = false;   // EOI 来自尾部探测而非顺序扫描
+  std::optional<uint64_t> trailing_bytes; // EOI 之后的尾随数据长度（已知时）
+};
+
+// 索引经过时接收段 payload（只能向前读取的数据源用）：
+// want() 为 true 的段在读过时交给 on_payload()，视图只在回调期间有效
+class SegmentSink {
+public:
+  virtual ~SegmentSink() = default;
+  virtual bool want(const SegmentIndex &seg) = 0;
+  virtual void on_payload(const SegmentIndex &seg, ByteSpan payload) = 0;
 };
 
+// 三种入口共用同一套 marker 逻辑：任意数据源 / 文件路径 / 内存区域。
+// sink 非空时顺带交付所需段的 payload，整个过程只向前读取
+JpegIndexResult build_jpeg_index(ByteSource &src, const IndexOptions &opt,
+                                 SegmentSink *sink = nullptr);
 JpegIndexResult build_jpeg_index(const std::string &path,
                                  const IndexOptions &opt);
+JpegIndexResult build_jpeg_index(const uint8_t *data, size_t len,
+                                 const IndexOptions &opt);
+
 bool load_segment_payload(const std::string &path, const SegmentIndex &seg,
                           std::vector<uint8_t> &out);
+// 从已映射的文件取段 payload 视图（零拷贝，视图随 MappedFile 失效）
+bool segment_payload(const MappedFile &file, const SegmentIndex &seg,
+                     ByteSpan &out);
+// 从任意数据源取段 payload：内存型数据源直接返回视图，否则读入 storage
+bool segment_payload(ByteSource &src, const SegmentIndex &seg,
+                     std::vector<uint8_t> &storage, ByteSpan &out);
@@ -1,7 +1,5 @@
 #pragma once
 #include <cstdint>
-#include <iomanip>
-#include <sstream>
 #include <string>
 
 inline bool marker_has_length(uint16_t m) {
@@ -30,20 +28,24 @@ inline std::string marker_name(uint16_t m) {
     return "DHT";
   case 0xFFDD:
     return "DRI";
-  default:
-    if (m >= 0xFFE0 && m <= 0xFFEF) {
-      int n = (int)(m - 0xFFE0);
-      return "APP" + std::to_string(n);
-    }
+  default: {
+    // 结果最长 9 个字符，落在 std::string 的短字符串缓冲内，不分配
+    static const char kHex[] = "0123456789ABCDEF";
+    static const char *const kApp[] = {
+        "APP0", "APP1", "APP2",  "APP3",  "APP4",  "APP5",  "APP6",  "APP7",
+        "APP8", "APP9", "APP10", "APP11", "APP12", "APP13", "APP14", "APP15"};
+    if (m >= 0xFFE0 && m <= 0xFFEF)
+      return kApp[m - 0xFFE0];
     if ((m >= 0xFFC0 && m <= 0xFFCF) && m != 0xFFC4 && m != 0xFFC8 &&
         m != 0xFFCC) {
-      std::ostringstream oss;
-      oss << "SOF(0x" << std::hex << std::uppercase << (m & 0xFF) << ")";
-      return oss.str();
+      // SOF(0xC0) 等
+      const char sof[] = {'S', 'O', 'F', '(', '0', 'x',
+                          kHex[(m >> 4) & 0xF], kHex[m & 0xF], ')'};
+      return std::string(sof, sizeof(sof));
     }
-    std::ostringstream oss;
-    oss << "0x" << std::hex << std::uppercase << std::setw(4)
-        << std::setfill('0') << m;
-    return oss.str();
+    const char hex[] = {'0', 'x', kHex[(m >> 12) & 0xF], kHex[(m >> 8) & 0xF],
+                        kHex[(m >> 4) & 0xF], kHex[m & 0xF]};
+    return std::string(hex, sizeof(hex));
+  }
   }
 }
@@ -0,0 +1,194 @@
+// jpeg_probe.cpp
+#include "jpeg_probe.h"
+#include "jpeg_markers.h"
+#include "parse_exif.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 栈上固定窗口：ensure() 不在窗口内时从目标偏移重新读取一整个窗口。
+// 内存型数据源直接引用其数据，不读取也不计数
+class ProbeWindow {
+public:
+  ProbeWindow(ByteSource &src, const ProbeOptions &opt, JpegProbe &out)
+      : src_(src), all_(src.contiguous()), out_(out),
+        window_(
+            std::clamp(opt.window_bytes, kMinProbeWindow, kMaxProbeWindow)),
+        max_reads_(opt.max_reads) {}
+
+  uint32_t window() const { return window_; }
+
+  ~ProbeWindow() {
+    if (all_.data() != nullptr)
+      src_.count_view(viewed_);
+  }
+
+  // 保证 [off, off+n) 可访问并返回其指针；越界、超出预算时返回 nullptr
+  const uint8_t *ensure(uint64_t off, size_t n) {
+    if (all_.data() != nullptr) {
+      if (off > all_.size() || n > all_.size() - off)
+        return nullptr;
+      viewed_ = std::max<uint64_t>(viewed_, off + n);
+      return all_.data() + off;
+    }
+    if (n > window_)
+      return nullptr;
+    if (off >= base_ && off + n <= base_ + len_)
+      return buf_ + (off - base_);
+    if (out_.reads >= max_reads_)
+      return nullptr;
+    size_t got = src_.read_at(off, buf_, window_);
+    out_.reads++;
+    out_.bytes_read += (uint32_t)got;
+    base_ = off;
+    len_ = got;
+    return got >= n ? buf_ : nullptr;
+  }
+
+private:
+  ByteSource &src_;
+  ByteSpan all_;
+  JpegProbe &out_;
+  uint32_t window_;
+  uint32_t max_reads_;
+  uint64_t base_ = 0;
+  size_t len_ = 0;
+  uint64_t viewed_ = 0;
+  uint8_t buf_[kMaxProbeWindow];
+};
+
+// 只在 IFD0 中查找 Orientation (0x0112)
+template <Endian E>
+uint8_t ifd0_orientation(ProbeWindow &w, uint64_t tiff_off, uint32_t tiff_len,
+                         const uint8_t *tiff) {
+  if (exif_load16<E>(tiff + 2) != 0x2A)
+    return 0;
+  uint32_t ifd0 = exif_load32<E>(tiff + 4);
+  if ((uint64_t)ifd0 + 2 > tiff_len)
+    return 0;
+  const uint8_t *p = w.ensure(tiff_off + ifd0, 2);
+  if (!p)
+    return 0;
+  uint16_t n = exif_load16<E>(p);
+  if ((uint64_t)ifd0 + 2 + (uint64_t)n * 12 > tiff_len)
+    return 0;
+  // 条目按窗口大小分批访问；重复的 Orientation 以最后一个为准（与完整解析一致）
+  uint8_t orientation = 0;
+  const uint16_t per_chunk = (uint16_t)std::min<size_t>(w.window() / 12, 0xFFFF);
+  if (per_chunk == 0)
+    return 0;
+  for (uint16_t i = 0; i < n;) {
+    uint16_t take = std::min<uint16_t>(per_chunk, (uint16_t)(n - i));
+    const uint8_t *ents =
+        w.ensure(tiff_off + ifd0 + 2 + (uint64_t)i * 12, (size_t)take * 12);
+    if (!ents)
+      return orientation;
+    for (uint16_t k = 0; k < take; k++) {
+      const uint8_t *e = ents + (size_t)k * 12;
+      if (exif_load16<E>(e) != 0x0112 || exif_load16<E>(e + 2) != 3) // SHORT
+        continue;
+      uint16_t v = exif_load16<E>(e + 8);
+      orientation = v >= 1 && v <= 8 ? (uint8_t)v : 0;
+    }
+    i = (uint16_t)(i + take);
+  }
+  return orientation;
+}
+
+uint8_t exif_orientation(ProbeWindow &w, uint64_t payload_off,
+                         uint32_t payload_len) {
+  if (payload_len < 6 + 8)
+    return 0;
+  const uint8_t *p = w.ensure(payload_off, 6 + 8);
+  if (!p || std::memcmp(p, "Exif\0\0", 6) != 0)
+    return 0;
+  const uint8_t *tiff = p + 6;
+  uint64_t tiff_off = payload_off + 6;
+  uint32_t tiff_len = payload_len - 6;
+  if (tiff[0] == 'I' && tiff[1] == 'I')
+    return ifd0_orientation<Endian::Little>(w, tiff_off, tiff_len, tiff);
+  if (tiff[0] == 'M' && tiff[1] == 'M')
+    return ifd0_orientation<Endian::Big>(w, tiff_off, tiff_len, tiff);
+  return 0;
+}
+
+bool is_frame_marker(uint16_t m) {
+  return m >= 0xFFC0 && m <= 0xFFCF && m != 0xFFC4 && m != 0xFFC8 &&
+         m != 0xFFCC;
+}
+
+} // namespace
+
+bool probe_jpeg(ByteSource &src, JpegProbe &out, const ProbeOptions &opt) {
+  out = JpegProbe();
+  ProbeWindow w(src, opt, out);
+  const uint8_t *p = w.ensure(0, 2);
+  if (!p || p[0] != 0xFF || p[1] != 0xD8)
+    return false;
+
+  bool exif_seen = false;
+  uint64_t pos = 2;
+  while (true) {
+    // marker 前可能有 0xFF 填充
+    p = w.ensure(pos, 2);
+    if (!p || p[0] != 0xFF)
+      return false;
+    if (p[1] == 0xFF) {
+      pos++;
+      continue;
+    }
+    uint16_t marker = (uint16_t)(0xFF00 | p[1]);
+    if (marker == 0xFFDA || marker == 0xFFD9) // SOF 之前遇到 SOS/EOI
+      return false;
+    if (!marker_has_length(marker)) {
+      pos += 2;
+      continue;
+    }
+    p = w.ensure(pos + 2, 2);
+    if (!p)
+      return false;
+    uint16_t seglen = (uint16_t)((p[0] << 8) | p[1]);
+    if (seglen < 2)
+      return false;
+    uint64_t payload_off = pos + 4;
+    uint32_t payload_len = seglen - 2u;
+
+    if (is_frame_marker(marker)) {
+      // P, Y, X, Nf
+      if (payload_len < 6 || !(p = w.ensure(payload_off, 6)))
+        return false;
+      out.sof_marker = marker;
+      out.precision = p[0];
+      out.height = (uint16_t)((p[1] << 8) | p[2]);
+      out.width = (uint16_t)((p[3] << 8) | p[4]);
+      out.components = p[5];
+      out.progressive = marker == 0xFFC2 || marker == 0xFFC6 ||
+                        marker == 0xFFCA || marker == 0xFFCE;
+      return true;
+    }
+    // APPn 位于帧之前，Orientation 取第一个包含它的 EXIF 段
+    if (marker == 0xFFE1 && !exif_seen) {
+      uint8_t o = exif_orientation(w, payload_off, payload_len);
+      if (o != 0) {
+        out.orientation = o;
+        exif_seen = true;
+      }
+    }
+    pos = payload_off + payload_len;
+  }
+}
+
+bool probe_jpeg(const std::string &path, JpegProbe &out,
+                const ProbeOptions &opt) {
+  FileSource src(path.c_str());
+  if (!src.ok())
+    return false;
+  return probe_jpeg(src, out, opt);
+}
+
+bool probe_jpeg_buffer(const uint8_t *data, size_t len, JpegProbe &out,
+                       const ProbeOptions &opt) {
+  MemorySource src(data, len);
+  return probe_jpeg(src, out, opt);
+}
@@ -0,0 +1,40 @@
+// jpeg_probe.h
+#pragma once
+#include "byte_source.h"
+#include <cstdint>
+#include <string>
+
+// 请求路径上的快速探测：只取尺寸、方向与编码方式，不建立段索引、不分配堆内存
+struct JpegProbe {
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint8_t components = 0;
+  uint8_t precision = 0;
+  uint16_t sof_marker = 0;  // 0xFFC0..0xFFCF
+  bool progressive = false; // SOF2/6/10/14
+  uint8_t orientation = 0;  // EXIF Orientation 1..8，没有时为 0
+  uint32_t reads = 0;       // 实际发出的 read_at 次数（内存型数据源为 0）
+  uint32_t bytes_read = 0;
+};
+
+// 字节预算：每次读取最多 window_bytes 字节，最多 max_reads 次，
+// 最坏情况读取 window_bytes * max_reads 字节（默认 16 KiB * 8 = 128 KiB）。
+// 典型相机文件的 SOF 位于前 16 KiB，只需一次读取；SOF 前有大段 ICC/XMP 时
+// 下一次读取直接跳到段之后的位置，被跳过的 payload 不会被读取。
+// 超出预算（如 SOF 前有十几段 64 KiB 的 ICC chunk）时返回 false，可退回 analyze_jpeg
+struct ProbeOptions {
+  // 限制在 [kMinProbeWindow, kMaxProbeWindow]（窗口位于栈上）
+  uint32_t window_bytes = 16 * 1024;
+  uint32_t max_reads = 8;
+};
+
+constexpr uint32_t kMaxProbeWindow = 64 * 1024;
+constexpr uint32_t kMinProbeWindow = 6 + 8; // Exif 标识 + TIFF 头
+
+// 找到 SOF 时返回 true；不是 JPEG、在 SOF 前遇到 SOS/EOI 或超出预算时返回 false
+bool probe_jpeg(ByteSource &src, JpegProbe &out,
+                const ProbeOptions &opt = ProbeOptions());
+bool probe_jpeg(const std::string &path, JpegProbe &out,
+                const ProbeOptions &opt = ProbeOptions());
+bool probe_jpeg_buffer(const uint8_t *data, size_t len, JpegProbe &out,
+                       const ProbeOptions &opt = ProbeOptions());
@@ -1,10 +1,37 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+// 非拥有的只读字节视图（C++17 没有 std::span）
+// 指向映射文件或调用方缓冲区，生命周期由数据源负责
+struct ByteSpan {
+  const uint8_t *ptr = nullptr;
+  size_t len = 0;
+
+  ByteSpan() = default;
+  ByteSpan(const uint8_t *p, size_t n) : ptr(p), len(n) {}
+  ByteSpan(const std::vector<uint8_t> &v) : ptr(v.data()), len(v.size()) {}
+
+  const uint8_t *data() const { return ptr; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  const uint8_t *begin() const { return ptr; }
+  const uint8_t *end() const { return ptr + len; }
+  const uint8_t &operator[](size_t i) const { return ptr[i]; }
+
+  // 越界部分自动截断
+  ByteSpan subspan(size_t off, size_t n = (size_t)-1) const {
+    if (off >= len)
+      return ByteSpan();
+    return ByteSpan(ptr + off, n < len - off ? n : len - off);
+  }
+};
+
 struct SegmentIndex {
   uint16_t marker = 0;
   uint64_t marker_offset = 0;  // marker 0xFF?? 起始位置
@@ -30,6 +57,22 @@ struct SofComponent {
   uint8_t qt = 0;
 };
 
+enum class ThumbnailKind {
+  Exif,        // EXIF IFD1 中的 JPEG
+  JfxxJpeg,    // JFXX 扩展码 0x10：JPEG
+  JfxxPalette, // JFXX 扩展码 0x11：宽、高、768 字节调色板 + 8 位索引像素
+  JfxxRgb,     // JFXX 扩展码 0x13：宽、高 + 24 位 RGB 像素
+};
+
+// 缩略图在源文件中的字节区间，提取时无需解码主图像
+struct ThumbnailInfo {
+  ThumbnailKind kind = ThumbnailKind::Exif;
+  uint64_t offset = 0; // 在源文件中的绝对偏移
+  uint64_t length = 0;
+  uint16_t width = 0; // 未知时为 0
+  uint16_t height = 0;
+};
+
 struct SofInfo {
   uint16_t marker = 0;
   uint8_t precision = 0;
@@ -51,12 +94,23 @@ struct ComInfo {
   std::string preview; // 预览（可限制）
 };
 
+// XMP 属性值的形式：单值或 rdf:Alt/Seq/Bag 数组
+enum class XmpValueForm : uint8_t { Simple, Alt, Seq, Bag };
+
+struct XmpProperty {
+  std::string name; // "前缀:本地名"，前缀取 XmpPropertySet 中登记的前缀
+  XmpValueForm form = XmpValueForm::Simple;
+  std::vector<std::string> values; // Simple 一项；数组每个 rdf:li 一项（已解码实体）
+};
+
 struct XmpInfo {
   uint32_t len = 0;           // segment payload 总长度
   uint32_t effective_len = 0; // 有效 XML 内容长度（不含 padding）
   uint32_t padding_len = 0;   // padding 长度
   std::string xml;            // 有效 XML 内容（不含 padding）
   bool truncated = false;     // 是否截断显示
+  // 按文件中出现的顺序；同名属性只保留第一次出现
+  std::vector<XmpProperty> properties;
 };
 
 struct IccProfile {
@@ -66,21 +120,37 @@ struct IccProfile {
 
 enum class Endian { Little, Big };
 
-struct ExifValue {
-  // 为了可读性：用“格式化后的文本”承载（不做复杂variant）
-  std::string text;
-};
+// tag 编号空间：IFD0/IFD1/EXIF IFD 共用 TIFF 编号，GPS 与 Interop IFD 单独编号
+enum class ExifNamespace : uint8_t { Tiff, Gps, Interop };
+
+// IFD 条目只记录原始字段和值数据在 TIFF 中的位置，
+// 需要时再通过 exif_value() 取类型化视图或 format_exif_value() 格式化
+constexpr uint32_t kExifNoData = 0xFFFFFFFF;
 
 struct ExifTag {
   uint16_t tag = 0;
   uint16_t type = 0;
   uint32_t count = 0;
   uint32_t value_or_offset = 0;
-  ExifValue value;
+  // 值数据在 TIFF 中的偏移（内联时指向条目的值字段）；
+  // 类型未知或越界时为 kExifNoData
+  uint32_t data_offset = kExifNoData;
+  uint32_t data_size = 0;
 };
 
+// IFD 条目按 tag 升序连续保存，按 tag 查找用二分
+// （文件中的 IFD 条目通常已按 tag 排序，构建时只需一次 reserve）
 struct ExifIfd {
-  std::map<uint16_t, ExifTag> tags;
+  ExifNamespace ns = ExifNamespace::Tiff;
+  std::vector<ExifTag> tags;
+
+  bool empty() const { return tags.empty(); }
+  const ExifTag *find(uint16_t tag) const {
+    auto it = std::lower_bound(
+        tags.begin(), tags.end(), tag,
+        [](const ExifTag &t, uint16_t v) { return t.tag < v; });
+    return it != tags.end() && it->tag == tag ? &*it : nullptr;
+  }
 };
 
 struct GpsCoord {
@@ -90,9 +160,15 @@ struct GpsCoord {
 
 struct ExifResult {
   Endian endian = Endian::Little;
+  // TIFF 数据（"Exif\0\0" 之后）视图；tiff_owner 非空时由结果自身持有
+  ByteSpan tiff;
+  std::shared_ptr<const std::vector<uint8_t>> tiff_owner;
   ExifIfd ifd0;
   ExifIfd exif_ifd;
   ExifIfd gps_ifd;
+  ExifIfd interop_ifd; // EXIF IFD 中 0xA005 指向
+  ExifIfd ifd1;        // IFD0 的 next 链接，通常描述缩略图
+  bool truncated = false; // 遇到循环/重叠偏移或超出 ExifLimits，结果不完整
   std::optional<GpsCoord> latitude;
   std::optional<GpsCoord> longitude;
 };
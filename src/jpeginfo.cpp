@@ -0,0 +1,238 @@
+// jpeginfo.cpp
+#include "jpeginfo.h"
+#include <list>
+
+static const ExifTagFilter &thumbnail_tag_filter() {
+  static const ExifTagFilter filter = [] {
+    ExifTagFilter f;
+    f.add("JPEGInterchangeFormat");
+    f.add("JPEGInterchangeFormatLength");
+    return f;
+  }();
+  return filter;
+}
+
+// 是否需要读取该段的 payload（与下面解析循环中的条件一致）
+static bool payload_wanted(const SegmentIndex &seg, const AnalyzeOptions &opt) {
+  switch (seg.marker) {
+  case 0xFFE0:
+    return (opt.want_jfif && seg.app_subtype == "JFIF") ||
+           (opt.want_thumbnails && seg.app_subtype == "JFXX");
+  case 0xFFE1:
+    return ((opt.want_exif || opt.want_thumbnails) &&
+            seg.app_subtype == "EXIF") ||
+           (opt.want_xmp && seg.app_subtype == "XMP");
+  case 0xFFE2:
+    return opt.want_icc && seg.app_subtype == "ICC";
+  case 0xFFEE:
+    return opt.want_adobe && seg.app_subtype == "Adobe";
+  case 0xFFFE:
+    return opt.want_com;
+  default:
+    return opt.want_sof && is_sof_marker(seg.marker);
+  }
+}
+
+// 解析一个段的 payload 并把结果追加到 out；ICC chunk 只收集视图，由调用方拼接
+static void parse_segment(const SegmentIndex &seg, ByteSpan payload,
+                          const AnalyzeOptions &opt, JpegInfo &out,
+                          IccCollector &icc) {
+  FileStats *stats = opt.stats;
+
+  // JFIF (APP0)
+  if (opt.want_jfif && seg.marker == 0xFFE0 && seg.app_subtype == "JFIF") {
+    PhaseTimer t(stats, Phase::ParseJfif);
+    auto jfif = parse_jfif_from_app0_payload(payload);
+    if (jfif.has_value())
+      out.jfif.push_back(std::move(*jfif));
+  }
+
+  // JFXX 缩略图 (APP0)
+  if (opt.want_thumbnails && seg.marker == 0xFFE0 &&
+      seg.app_subtype == "JFXX") {
+    PhaseTimer t(stats, Phase::ParseJfif);
+    auto thumb = parse_jfxx_thumbnail(payload, seg.payload_offset);
+    if (thumb.has_value())
+      out.thumbnails.push_back(*thumb);
+  }
+
+  // SOF (Start of Frame)
+  if (opt.want_sof && is_sof_marker(seg.marker)) {
+    PhaseTimer t(stats, Phase::ParseSof);
+    auto sof = parse_sof_payload(seg.marker, payload);
+    if (sof.has_value())
+      out.sof.push_back(std::move(*sof));
+  }
+
+  // EXIF (APP1)；缩略图位置来自 IFD1
+  if ((opt.want_exif || opt.want_thumbnails) && seg.marker == 0xFFE1 &&
+      seg.app_subtype == "EXIF") {
+    PhaseTimer t(stats, Phase::ParseExif);
+    std::optional<ExifResult> exif;
+    if (opt.want_exif)
+      exif = parse_exif_from_app1_payload(payload, &opt.exif_tags,
+                                          opt.exif_limits);
+    if (opt.want_thumbnails) {
+      // 完整解析的结果已包含 IFD1，否则只取缩略图的两个 tag
+      std::optional<ExifResult> thumb_exif;
+      const ExifResult *src_exif = nullptr;
+      if (exif.has_value() && opt.exif_tags.empty()) {
+        src_exif = &*exif;
+      } else {
+        thumb_exif = parse_exif_from_app1_payload(
+            payload, &thumbnail_tag_filter(), opt.exif_limits);
+        src_exif = thumb_exif ? &*thumb_exif : nullptr;
+      }
+      if (src_exif) {
+        auto thumb = exif_thumbnail(*src_exif, seg.payload_offset + 6);
+        if (thumb.has_value())
+          out.thumbnails.push_back(*thumb);
+      }
+    }
+    if (exif.has_value()) {
+      exif_retain(*exif); // payload 视图在返回后失效
+      out.exif.push_back(std::move(*exif));
+    }
+  }
+
+  // XMP (APP1)
+  if (opt.want_xmp && seg.marker == 0xFFE1 && seg.app_subtype == "XMP") {
+    PhaseTimer t(stats, Phase::ParseXmp);
+    auto xmp =
+        parse_xmp_from_app1_payload(payload, opt.xmp_full, opt.xmp_max_preview,
+                                    opt.xmp_properties ? *opt.xmp_properties
+                                                       : XmpPropertySet::common());
+    if (xmp.has_value())
+      out.xmp.push_back(std::move(*xmp));
+  }
+
+  // ICC Profile (APP2)：只收集，遍历结束后一次拼接
+  if (opt.want_icc && seg.marker == 0xFFE2 && seg.app_subtype == "ICC") {
+    PhaseTimer t(stats, Phase::ParseIcc);
+    icc.add(payload);
+  }
+
+  // Adobe (APP14)
+  if (opt.want_adobe && seg.marker == 0xFFEE && seg.app_subtype == "Adobe") {
+    PhaseTimer t(stats, Phase::ParseAdobe);
+    auto adobe = parse_adobe_app14_payload(payload);
+    if (adobe.has_value())
+      out.adobe.push_back(std::move(*adobe));
+  }
+
+  // COM (Comment)
+  if (opt.want_com && seg.marker == 0xFFFE) {
+    PhaseTimer t(stats, Phase::ParseCom);
+    out.com.push_back(parse_com_payload_preview(payload, opt.com_max_preview));
+  }
+}
+
+// 只能向前读取的数据源：索引经过各段时直接解析，不回头读取。
+// 只有 ICC chunk 需要保留到遍历结束，其余 payload 视图用完即弃
+class StreamingParser : public SegmentSink {
+public:
+  StreamingParser(const AnalyzeOptions &opt, JpegInfo &out)
+      : opt_(opt), out_(out) {}
+
+  bool want(const SegmentIndex &seg) override {
+    return payload_wanted(seg, opt_);
+  }
+  void on_payload(const SegmentIndex &seg, ByteSpan payload) override {
+    if (seg.marker == 0xFFE2) {
+      icc_storage_.emplace_back(payload.begin(), payload.end());
+      payload = ByteSpan(icc_storage_.back());
+    }
+    parse_segment(seg, payload, opt_, out_, icc_);
+  }
+
+  IccCollector &icc() { return icc_; }
+
+private:
+  const AnalyzeOptions &opt_;
+  JpegInfo &out_;
+  IccCollector icc_;
+  std::list<std::vector<uint8_t>> icc_storage_;
+};
+
+static bool analyze_stream(ByteSource &src, const IndexOptions &iopt,
+                           const AnalyzeOptions &opt, JpegInfo &out) {
+  FileStats *stats = opt.stats;
+  const IoCounters io_before = src.io();
+  StreamingParser parser(opt, out);
+  // 索引与解析交错进行，这里只统计各 parse_* 阶段，不单独计索引时间
+  out.index = build_jpeg_index(src, iopt, &parser);
+  bool ok = !out.index.segments.empty();
+  if (ok && !parser.icc().empty()) {
+    PhaseTimer t(stats, Phase::ParseIcc);
+    out.icc = parser.icc().finish();
+  }
+  if (stats)
+    stats->io.add(src.io().since(io_before));
+  return ok;
+}
+
+bool analyze_jpeg(ByteSource &src, const AnalyzeOptions &opt, JpegInfo &out) {
+  FileStats *stats = opt.stats;
+  const IoCounters io_before = src.io();
+
+  IndexOptions iopt = opt.index;
+  // 不需要分区列表时不需要 EOI，元数据都在第一个 SOS 之前
+  iopt.stop_at_sos = !opt.want_full_index;
+  iopt.probe_tail = !opt.want_full_index && opt.probe_tail;
+  if (!src.seekable())
+    return analyze_stream(src, iopt, opt, out);
+  {
+    PhaseTimer t(stats, Phase::Index);
+    out.index = build_jpeg_index(src, iopt);
+  }
+  if (out.index.segments.empty()) {
+    if (stats)
+      stats->io.add(src.io().since(io_before));
+    return false;
+  }
+
+  // 先登记所有需要的段再一次性加载：相邻段合并成少量大读取，
+  // 内存型数据源（映射文件/内存缓冲）则直接返回零拷贝视图。
+  // 各段视图在 loader 销毁前都有效，ICC chunk 可以收集后再拼接
+  SegmentLoader loader(src, opt.coalesce);
+  {
+    PhaseTimer t(stats, Phase::PayloadLoad);
+    for (const auto &seg : out.index.segments)
+      if (payload_wanted(seg, opt))
+        loader.want(seg);
+    loader.fetch();
+  }
+  IccCollector icc;
+  ByteSpan payload;
+  auto load = [&](const SegmentIndex &seg) {
+    PhaseTimer t(stats, Phase::PayloadLoad);
+    return loader.payload(seg, payload);
+  };
+
+  for (const auto &seg : out.index.segments)
+    if (payload_wanted(seg, opt) && load(seg))
+      parse_segment(seg, payload, opt, out, icc);
+
+  if (!icc.empty()) {
+    PhaseTimer t(stats, Phase::ParseIcc);
+    out.icc = icc.finish();
+  }
+  if (stats)
+    stats->io.add(src.io().since(io_before));
+  return true;
+}
+
+bool analyze_jpeg(const std::string &path, const AnalyzeOptions &opt,
+                  JpegInfo &out) {
+  // 整个文件只映射一次，索引和各段解析都直接读映射区域
+  MappedFile file(path.c_str());
+  if (!file.ok())
+    return false;
+  return analyze_jpeg(file, opt, out);
+}
+
+bool analyze_jpeg_buffer(const uint8_t *data, size_t len,
+                         const AnalyzeOptions &opt, JpegInfo &out) {
+  MemorySource src(data, len);
+  return analyze_jpeg(src, opt, out);
+}
@@ -0,0 +1,74 @@
+// jpeginfo.h
+// libjpeginfo 公共头文件：段索引、各类元数据解析与一次性分析入口
+#pragma once
+#include "byte_source.h"
+#include "jpeg_indexer.h"
+#include "jpeg_markers.h"
+#include "jpeg_probe.h"
+#include "jpeg_types.h"
+#include "mapped_file.h"
+#include "parse_adobe.h"
+#include "parse_com.h"
+#include "parse_exif.h"
+#include "parse_icc.h"
+#include "parse_jfif.h"
+#include "parse_sof.h"
+#include "parse_thumbnail.h"
+#include "parse_xmp.h"
+#include "segment_loader.h"
+#include "stats.h"
+#include <string>
+#include <vector>
+
+struct AnalyzeOptions {
+  // 需要解析的内容
+  bool want_jfif = true;
+  bool want_sof = true;
+  bool want_exif = true;
+  bool want_xmp = true;
+  bool want_icc = true;
+  bool want_adobe = true;
+  bool want_com = true;
+  bool want_thumbnails = true; // EXIF IFD1 与 JFXX 缩略图位置
+
+  // 需要完整的分区列表（含 EOI）时才扫描熵编码数据
+  bool want_full_index = true;
+  bool probe_tail = false; // !want_full_index 时通过文件尾部探测 EOI
+
+  ExifTagFilter exif_tags;       // 为空时提取全部 EXIF tag
+  ExifLimits exif_limits;
+  bool xmp_full = true;          // XMP 不截断
+  size_t xmp_max_preview = 2048; // xmp_full=false 时的预览长度
+  // 提取的 XMP 属性；为空指针时使用 XmpPropertySet::common()，指向空集合时不提取
+  const XmpPropertySet *xmp_properties = nullptr;
+  size_t com_max_preview = 256;
+
+  IndexOptions index; // stop_at_sos/probe_tail 由上面的选项决定
+  CoalesceOptions coalesce; // 非内存数据源上 payload 读取的合并策略
+
+  // 非空时累加各阶段耗时与 I/O 计数
+  FileStats *stats = nullptr;
+};
+
+// 一个文件的分析结果；同类段按文件中出现的顺序保存
+struct JpegInfo {
+  JpegIndexResult index;
+  std::vector<JfifInfo> jfif;
+  std::vector<SofInfo> sof;
+  std::vector<ExifResult> exif;
+  std::vector<XmpInfo> xmp;
+  std::optional<IccProfile> icc; // 所有 ICC chunk 拼接后的完整 profile
+  std::vector<AdobeInfo> adobe;
+  std::vector<ComInfo> com;
+  std::vector<ThumbnailInfo> thumbnails; // 按文件中出现的顺序
+};
+
+// 索引并解析文件，文件无法打开或不是 JPEG 时返回 false
+bool analyze_jpeg(const std::string &path, const AnalyzeOptions &opt,
+                  JpegInfo &out);
+// 直接解析内存中的 JPEG（如上传请求体），不经过文件系统
+bool analyze_jpeg_buffer(const uint8_t *data, size_t len,
+                         const AnalyzeOptions &opt, JpegInfo &out);
+// 任意数据源（自定义 ByteSource 实现）。只能向前读取的数据源（StreamSource 等）
+// 在索引经过时直接解析各段，不回头读取；want_full_index=false 时读到第一个 SOS 即停止
+bool analyze_jpeg(ByteSource &src, const AnalyzeOptions &opt, JpegInfo &out);
@@ -0,0 +1,158 @@
+// json_writer.cpp
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+void JsonWriter::separate() {
+  if (need_comma_)
+    out_ += ',';
+  need_comma_ = true;
+}
+
+JsonWriter &JsonWriter::open(char c) {
+  separate();
+  out_ += c;
+  need_comma_ = false;
+  return *this;
+}
+
+JsonWriter &JsonWriter::close(char c) {
+  out_ += c;
+  need_comma_ = true;
+  return *this;
+}
+
+JsonWriter &JsonWriter::key(std::string_view k) {
+  separate();
+  write_string(k);
+  out_ += ':';
+  need_comma_ = false;
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view v) {
+  separate();
+  write_string(v);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(bool v) {
+  separate();
+  out_ += v ? "true" : "false";
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(double v) {
+  if (!std::isfinite(v))
+    return null();
+  separate();
+  char buf[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  auto res = std::to_chars(buf, buf + sizeof(buf), v,
+                           std::chars_format::general, 15);
+  out_.append(buf, (size_t)(res.ptr - buf));
+#else
+  int n = std::snprintf(buf, sizeof(buf), "%.15g", v);
+  out_.append(buf, (size_t)n);
+#endif
+  return *this;
+}
+
+JsonWriter &JsonWriter::null() {
+  separate();
+  out_ += "null";
+  return *this;
+}
+
+void JsonWriter::write_uint(uint64_t v) {
+  separate();
+  char buf[24];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v);
+  out_.append(buf, (size_t)(res.ptr - buf));
+}
+
+void JsonWriter::write_int(int64_t v) {
+  separate();
+  char buf[24];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v);
+  out_.append(buf, (size_t)(res.ptr - buf));
+}
+
+// 合法 UTF-8 序列的长度，非法时返回 0
+static size_t utf8_sequence(const unsigned char *p, size_t n) {
+  unsigned char c = p[0];
+  size_t len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+  if (len == 0 || c > 0xF4 || (c & 0xFE) == 0xC0 || len > n)
+    return 0;
+  for (size_t i = 1; i < len; i++)
+    if ((p[i] & 0xC0) != 0x80)
+      return 0;
+  // 过长编码、代理区与超出 U+10FFFF 的码点
+  if ((c == 0xE0 && p[1] < 0xA0) || (c == 0xED && p[1] >= 0xA0) ||
+      (c == 0xF0 && p[1] < 0x90) || (c == 0xF4 && p[1] >= 0x90))
+    return 0;
+  return len;
+}
+
+// 需要逐字节处理的字节：控制字符、引号、反斜杠与非 ASCII
+static constexpr auto kSpecial = [] {
+  struct Table {
+    bool v[256] = {};
+  } t;
+  for (int c = 0; c < 256; c++)
+    t.v[c] = c < 0x20 || c >= 0x80 || c == '"' || c == '\\';
+  return t;
+}();
+
+void JsonWriter::write_string(std::string_view s) {
+  static const char kHex[] = "0123456789abcdef";
+  const auto *p = (const unsigned char *)s.data();
+  const size_t n = s.size();
+  out_.reserve(out_.size() + n + 2);
+  out_ += '"';
+  size_t run = 0; // 无需转义的连续字节从 run 开始
+  for (size_t i = 0; i < n;) {
+    if (!kSpecial.v[p[i]]) {
+      i++;
+      continue;
+    }
+    unsigned char c = p[i];
+    if (c >= 0x80) {
+      size_t len = utf8_sequence(p + i, n - i);
+      if (len) {
+        i += len;
+        continue;
+      }
+    }
+    out_.append(s.data() + run, i - run);
+    switch (c) {
+    case '"':
+      out_ += "\\\"";
+      break;
+    case '\\':
+      out_ += "\\\\";
+      break;
+    case '\n':
+      out_ += "\\n";
+      break;
+    case '\r':
+      out_ += "\\r";
+      break;
+    case '\t':
+      out_ += "\\t";
+      break;
+    default:
+      if (c < 0x20) {
+        out_ += "\\u00";
+        out_ += kHex[c >> 4];
+        out_ += kHex[c & 0xF];
+      } else {
+        out_ += "\xEF\xBF\xBD"; // U+FFFD
+      }
+    }
+    run = ++i;
+  }
+  out_.append(s.data() + run, n - run);
+  out_ += '"';
+}
@@ -0,0 +1,53 @@
+// json_writer.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 流式 JSON 写入器：直接追加到调用方的输出缓冲，不建立中间文档树。
+// 只负责语法（逗号、转义）；字段顺序与嵌套由调用方保证。
+// 字符串按 UTF-8 输出，非法字节替换为 U+FFFD，控制字符转义为 \uXXXX
+class JsonWriter {
+public:
+  explicit JsonWriter(std::string &out) : out_(out) {}
+
+  JsonWriter &begin_object() { return open('{'); }
+  JsonWriter &end_object() { return close('}'); }
+  JsonWriter &begin_array() { return open('['); }
+  JsonWriter &end_array() { return close(']'); }
+
+  JsonWriter &key(std::string_view k);
+
+  JsonWriter &value(std::string_view v);
+  JsonWriter &value(const char *v) { return value(std::string_view(v)); }
+  JsonWriter &value(bool v);
+  JsonWriter &value(double v); // 非有限值输出 null
+  template <class T, std::enable_if_t<std::is_integral_v<T> &&
+                                          !std::is_same_v<T, bool>,
+                                      int> = 0>
+  JsonWriter &value(T v) {
+    if constexpr (std::is_signed_v<T>)
+      write_int((int64_t)v);
+    else
+      write_uint((uint64_t)v);
+    return *this;
+  }
+  JsonWriter &null();
+
+  template <class T> JsonWriter &field(std::string_view k, const T &v) {
+    key(k);
+    return value(v);
+  }
+
+private:
+  JsonWriter &open(char c);
+  JsonWriter &close(char c);
+  void separate();
+  void write_uint(uint64_t v);
+  void write_int(int64_t v);
+  void write_string(std::string_view s);
+
+  std::string &out_;
+  bool need_comma_ = false; // 同一层级中前面已有值
+};
@@ -1,25 +1,35 @@
 // main.cpp
+#include "alloc_counter.h"
+#include "batch.h"
+#include "columnar.h"
 #include "format.h"
+#include "format_json.h"
 #include "i18n.h"
-#include "jpeg_indexer.h"
-#include "parse_adobe.h"
-#include "parse_com.h"
-#include "parse_exif.h"
-#include "parse_icc.h"
-#include "parse_jfif.h"
-#include "parse_sof.h"
-#include "parse_xmp.h"
+#include "jpeginfo.h"
+#include "text_writer.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
 
-int main(int argc, char *argv[]) {
-  I18n i18n;
-  i18n.lang = Lang::ZH; // 默认中文
+// 数据源后端：内存映射 / FILE* 读取 / 按区间拉取（本地模拟对象存储）
+enum class IoMode { Mmap, Read, Ranged };
 
-  std::string path;
-  bool help_requested = false;
+// 输出格式：文本 / JSON 数组 / 每个文件一行 JSON / 列式二进制文件
+enum class OutputFormat { Text, Json, Ndjson, Columnar };
 
+struct CliOptions {
   // 过滤选项
   bool show_segments = false;
   bool show_jfif = false;
@@ -29,52 +39,375 @@ int main(int argc, char *argv[]) {
   bool show_icc = false;
   bool show_adobe = false;
   bool show_com = false;
+  bool show_thumbnails = false;
+  bool extract_thumbnails = false;
+  std::string thumbnail_dir; // 为空时写到源文件所在目录
+  bool meta_only = false;
+  ExifTagFilter exif_tags; // --tags=，为空时输出全部 EXIF tag
+  XmpPropertySet xmp_props; // --xmp-props=，为空时提取常用属性
+  IoMode io = IoMode::Mmap;
+  OutputFormat format = OutputFormat::Text;
+};
+
+enum class StatsMode { Off, Text, Json };
+
+// 把 JPEG 缩略图写成 <目录>/<文件名>.thumb.jpg (EXIF) 或 .jfxx.jpg (JFXX)
+static bool extract_thumbnails(const std::string &path, ByteSource &file,
+                               const std::vector<ThumbnailInfo> &thumbs,
+                               const CliOptions &cli, const I18n &i18n,
+                               std::string &listing, std::ostream &es) {
+  namespace fs = std::filesystem;
+  fs::path src(path);
+  fs::path dir = cli.thumbnail_dir.empty() ? src.parent_path()
+                                           : fs::path(cli.thumbnail_dir);
+  std::string stem = src.stem().string();
+  bool ok = true;
+  int exif_n = 0, jfxx_n = 0;
+  for (const auto &t : thumbs) {
+    if (!thumbnail_is_jpeg(t))
+      continue;
+    bool is_exif = t.kind == ThumbnailKind::Exif;
+    int n = is_exif ? exif_n++ : jfxx_n++;
+    std::string name = stem + (is_exif ? ".thumb" : ".jfxx");
+    if (n > 0)
+      name += "-" + std::to_string(n + 1);
+    fs::path out = dir / (name + ".jpg");
+
+    std::vector<uint8_t> storage;
+    ByteSpan bytes;
+    // 只能向前读取的数据源（标准输入）已经越过缩略图，取不到字节
+    bool got = thumbnail_bytes(file, t, storage, bytes);
+    std::ofstream f;
+    if (got)
+      f.open(out, std::ios::binary);
+    if (f)
+      f.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+    if (!got || !f) {
+      es << i18n.t(Msg::ErrorWrite) << ": " << out.string() << "\n";
+      ok = false;
+      continue;
+    }
+    TextWriter(listing) << "  -> " << out.string() << "\n";
+  }
+  return ok;
+}
+
+// 按 --io 打开数据源，失败返回空；"-" 为标准输入（只向前读取）
+static std::unique_ptr<ByteSource> open_source(const std::string &path,
+                                               IoMode mode) {
+  if (path == "-")
+    return std::make_unique<StreamSource>(stdin);
+  switch (mode) {
+  case IoMode::Read: {
+    auto src = std::make_unique<FileSource>(path.c_str());
+    return src->ok() ? std::move(src) : nullptr;
+  }
+  case IoMode::Ranged: {
+    auto src = std::make_unique<LocalRangedSource>(path.c_str());
+    return src->ok() ? std::move(src) : nullptr;
+  }
+  case IoMode::Mmap:
+    break;
+  }
+  auto src = std::make_unique<MappedFile>(path.c_str());
+  return src->ok() ? std::move(src) : nullptr;
+}
+
+static void print_text(std::string &out, const std::string &path,
+                       const JpegInfo &info, const CliOptions &cli,
+                       const I18n &i18n) {
+  TextWriter(out) << "JPEG Info: " << path << "\n";
+  out.append(80, '=');
+  out += '\n';
+
+  if (cli.show_segments)
+    print_segments(out, info.index.segments, i18n);
+  for (const auto &jfif : info.jfif)
+    print_jfif_info(out, jfif, i18n);
+  for (const auto &sof : info.sof)
+    print_sof_info(out, sof, i18n);
+  for (const auto &exif : info.exif)
+    print_exif_info(out, exif, i18n);
+  for (const auto &xmp : info.xmp)
+    print_xmp_info(out, xmp, i18n);
+  if (info.icc.has_value())
+    print_icc_info(out, *info.icc, i18n);
+  for (const auto &adobe : info.adobe)
+    print_adobe_info(out, adobe, i18n);
+  for (const auto &com : info.com)
+    print_com_info(out, com, i18n);
+  if (cli.show_thumbnails)
+    print_thumbnail_info(out, info.thumbnails, i18n);
+}
+
+static void write_json(std::string &out, const std::string &path,
+                       const JpegInfo &info, const CliOptions &cli) {
+  JsonSections sel;
+  sel.segments = cli.show_segments;
+  sel.jfif = cli.show_jfif;
+  sel.sof = cli.show_sof;
+  sel.exif = cli.show_exif;
+  sel.xmp = cli.show_xmp;
+  sel.icc = cli.show_icc;
+  sel.adobe = cli.show_adobe;
+  sel.com = cli.show_com;
+  sel.thumbnails = cli.show_thumbnails;
+  JsonWriter w(out);
+  write_jpeg_json(w, path, info, sel);
+}
+
+// 处理单个文件，输出追加到 out，错误写入 es
+static bool process_file(const std::string &path, const CliOptions &cli,
+                         const I18n &i18n, std::string &out, std::ostream &es,
+                         FileStats *stats) {
+  AnalyzeOptions opt;
+  opt.want_jfif = cli.show_jfif;
+  opt.want_sof = cli.show_sof;
+  opt.want_exif = cli.show_exif;
+  opt.want_xmp = cli.show_xmp;
+  opt.want_icc = cli.show_icc;
+  opt.want_adobe = cli.show_adobe;
+  opt.want_com = cli.show_com;
+  opt.want_thumbnails = cli.show_thumbnails;
+  opt.want_full_index = cli.show_segments && !cli.meta_only;
+  opt.probe_tail = cli.meta_only;
+  opt.exif_tags = cli.exif_tags;
+  if (!cli.xmp_props.empty())
+    opt.xmp_properties = &cli.xmp_props;
+  opt.index.app_peek_bytes = 128; // 读取更多字节用于识别APP子类型
+  opt.stats = stats;
+
+  const bool json = cli.format != OutputFormat::Text;
+  // 提取缩略图时保留数据源，映射文件的缩略图直接从映射区域写出
+  std::unique_ptr<ByteSource> file = open_source(path, cli.io);
+  JpegInfo info;
+  if (!file || !analyze_jpeg(*file, opt, info)) {
+    es << i18n.t(Msg::ErrorParse) << ": " << path << "\n";
+    if (json) {
+      JsonWriter w(out);
+      write_error_json(w, path, "parse");
+    }
+    return false;
+  }
+
+  PhaseTimer format_timer(stats, Phase::Format);
+  if (json) {
+    // JSON 直接写入输出缓冲；缩略图写出的路径列表改到标准错误
+    write_json(out, path, info, cli);
+    if (cli.extract_thumbnails) {
+      std::string listing;
+      bool ok =
+          extract_thumbnails(path, *file, info.thumbnails, cli, i18n, listing, es);
+      es << listing;
+      return ok;
+    }
+    return true;
+  }
+  // 文本直接格式化到输出缓冲，不经过 ostringstream
+  print_text(out, path, info, cli, i18n);
+  return !cli.extract_thumbnails ||
+         extract_thumbnails(path, *file, info.thumbnails, cli, i18n, out, es);
+}
+
+// 列式导出：只解析导出字段需要的内容，输出块是一行记录的序列化
+static bool export_record(const std::string &path, const CliOptions &cli,
+                          const I18n &i18n, std::string &out, std::ostream &es,
+                          FileStats *stats) {
+  AnalyzeOptions opt;
+  opt.want_jfif = opt.want_adobe = opt.want_com = opt.want_thumbnails = false;
+  opt.want_full_index = !cli.meta_only;
+  opt.probe_tail = cli.meta_only;
+  opt.exif_tags = meta_record_exif_tags();
+  static const XmpPropertySet no_props;
+  opt.xmp_full = false; // 只需要长度
+  opt.xmp_max_preview = 0;
+  opt.xmp_properties = &no_props;
+  opt.stats = stats;
+
+  std::unique_ptr<ByteSource> file = open_source(path, cli.io);
+  JpegInfo info;
+  if (!file || !analyze_jpeg(*file, opt, info)) {
+    es << i18n.t(Msg::ErrorParse) << ": " << path << "\n";
+    return false;
+  }
+  PhaseTimer format_timer(stats, Phase::Format);
+  MetaRecord rec;
+  make_meta_record(path, info, rec);
+  encode_meta_record(rec, out);
+  return true;
+}
+
+// 逗号分隔的列表逐项 add() 到 ExifTagFilter / XmpPropertySet；
+// 未知名称写入 bad 并返回 false
+template <class Filter>
+static bool parse_list(const std::string &list, Filter &filter,
+                       std::string &bad) {
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t comma = list.find(',', start);
+    if (comma == std::string::npos)
+      comma = list.size();
+    std::string item = list.substr(start, comma - start);
+    if (!item.empty() && !filter.add(item)) {
+      bad = item;
+      return false;
+    }
+    start = comma + 1;
+  }
+  return !filter.empty();
+}
+
+static bool parse_jobs(const std::string &s, unsigned &out) {
+  char *end = nullptr;
+  unsigned long v = std::strtoul(s.c_str(), &end, 10);
+  if (s.empty() || *end != '\0' || v == 0)
+    return false;
+  out = (unsigned)v;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  I18n i18n;
+  i18n.lang = Lang::ZH; // 默认中文
+#if defined(_WIN32)
+  _setmode(_fileno(stdin), _O_BINARY); // "-" 输入按二进制读取
+#endif
+
+  std::vector<std::string> inputs;
+  bool help_requested = false;
+  bool bad_args = false;
+  CliOptions cli;
   bool any_filter_set = false;
+  StatsMode stats_mode = StatsMode::Off;
+
+  BatchOptions batch;
+  batch.jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  // 先确定界面语言，参数错误按 --lang 输出，与它出现的位置无关
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--lang=en")
+      i18n.lang = Lang::EN;
+    else if (arg == "--lang=zh")
+      i18n.lang = Lang::ZH;
+  }
 
   // 解析命令行参数
   for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
     if (arg == "-h" || arg == "--help") {
       help_requested = true;
-    } else if (arg == "--lang=en") {
-      i18n.lang = Lang::EN;
-    } else if (arg == "--lang=zh") {
-      i18n.lang = Lang::ZH;
+    } else if (arg == "--lang=en" || arg == "--lang=zh") {
+      // 已在上面处理
+    } else if (arg == "-j" && i + 1 < argc) {
+      bad_args |= !parse_jobs(argv[++i], batch.jobs);
+    } else if (arg.rfind("-j", 0) == 0 && arg.size() > 2 && arg[2] != '-') {
+      bad_args |= !parse_jobs(arg.substr(2), batch.jobs);
+    } else if (arg.rfind("--jobs=", 0) == 0) {
+      bad_args |= !parse_jobs(arg.substr(7), batch.jobs);
+    } else if (arg == "--order=input") {
+      batch.order = OutputOrder::Input;
+    } else if (arg == "--order=completion") {
+      batch.order = OutputOrder::Completion;
+    } else if (arg == "--stats" || arg == "--stats=text") {
+      stats_mode = StatsMode::Text;
+    } else if (arg == "--stats=json") {
+      stats_mode = StatsMode::Json;
+    } else if (arg.rfind("--tags=", 0) == 0) {
+      std::string bad;
+      if (!parse_list(arg.substr(7), cli.exif_tags, bad)) {
+        std::cerr << i18n.t(Msg::UnknownExifTag) << ": " << bad << "\n";
+        bad_args = true;
+      }
+    } else if (arg.rfind("--xmp-props=", 0) == 0) {
+      std::string bad;
+      if (!parse_list(arg.substr(12), cli.xmp_props, bad)) {
+        std::cerr << i18n.t(Msg::UnknownXmpProperty) << ": " << bad << "\n";
+        bad_args = true;
+      }
+    } else if (arg == "--io=mmap") {
+      cli.io = IoMode::Mmap;
+    } else if (arg == "--io=read") {
+      cli.io = IoMode::Read;
+    } else if (arg == "--io=ranged") {
+      cli.io = IoMode::Ranged;
+    } else if (arg == "--format=text") {
+      cli.format = OutputFormat::Text;
+    } else if (arg == "--format=json") {
+      cli.format = OutputFormat::Json;
+    } else if (arg == "--format=ndjson") {
+      cli.format = OutputFormat::Ndjson;
+    } else if (arg == "--format=columnar") {
+      cli.format = OutputFormat::Columnar;
+    } else if (arg == "--meta-only") {
+      cli.meta_only = true;
     } else if (arg == "--segments") {
-      show_segments = true;
+      cli.show_segments = true;
       any_filter_set = true;
     } else if (arg == "--jfif") {
-      show_jfif = true;
+      cli.show_jfif = true;
       any_filter_set = true;
     } else if (arg == "--sof") {
-      show_sof = true;
+      cli.show_sof = true;
       any_filter_set = true;
     } else if (arg == "--exif") {
-      show_exif = true;
+      cli.show_exif = true;
       any_filter_set = true;
     } else if (arg == "--xmp") {
-      show_xmp = true;
+      cli.show_xmp = true;
       any_filter_set = true;
     } else if (arg == "--icc") {
-      show_icc = true;
+      cli.show_icc = true;
       any_filter_set = true;
     } else if (arg == "--adobe") {
-      show_adobe = true;
+      cli.show_adobe = true;
       any_filter_set = true;
     } else if (arg == "--com") {
-      show_com = true;
+      cli.show_com = true;
+      any_filter_set = true;
+    } else if (arg == "--thumbnail") {
+      cli.show_thumbnails = true;
       any_filter_set = true;
-    } else if (path.empty()) {
-      path = arg;
+    } else if (arg == "--extract-thumbnail" ||
+               arg.rfind("--extract-thumbnail=", 0) == 0) {
+      cli.show_thumbnails = cli.extract_thumbnails = true;
+      if (arg.size() > 20)
+        cli.thumbnail_dir = arg.substr(20);
+      any_filter_set = true;
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      std::cerr << i18n.t(Msg::UnknownOption) << ": " << arg << "\n";
+      bad_args = true;
+    } else {
+      inputs.push_back(arg);
     }
   }
+  // 列式导出的列是固定的，所需 EXIF tag 由 meta_record_exif_tags() 决定；
+  // --tags 只会让这些列变空
+  if (cli.format == OutputFormat::Columnar && !cli.exif_tags.empty()) {
+    std::cerr << i18n.t(Msg::ErrorColumnarTags) << "\n";
+    bad_args = true;
+  }
 
-  if (help_requested || path.empty()) {
+  if (help_requested || inputs.empty() || bad_args) {
     std::cout << "JPEG Info - JPEG 元数据解析工具\n\n";
-    std::cout << "用法: " << argv[0] << " <jpeg文件> [选项]\n\n";
+    std::cout << "用法: " << argv[0]
+              << " <jpeg文件|目录|@列表文件|->... [选项]\n\n";
     std::cout << "选项:\n";
     std::cout << "  -h, --help      显示此帮助信息\n";
-    std::cout << "  --lang=en|zh    设置显示语言 (默认: zh)\n\n";
+    std::cout << "  -               从标准输入读取 (管道，只向前读取)\n";
+    std::cout << "  --lang=en|zh    设置显示语言 (默认: zh)\n";
+    std::cout << "  --meta-only     不扫描压缩数据，EOI 通过文件尾部探测\n";
+    std::cout << "  --format=text|json|ndjson|columnar\n";
+    std::cout << "                  输出格式: 文本 / JSON 数组 / 每个文件一行 JSON /\n";
+    std::cout << "                  列式二进制文件 (默认: text)；columnar 的列固定，\n";
+    std::cout << "                  不能与 --tags 同时使用\n";
+    std::cout << "  --io=mmap|read|ranged\n";
+    std::cout << "                  数据源: 内存映射 / 文件读取 / 按区间拉取 (默认: mmap)\n";
+    std::cout << "  --stats[=json]  在标准错误输出各阶段耗时、I/O、分配次数与延迟分布\n\n";
+    std::cout << "批量处理选项:\n";
+    std::cout << "  -j N, --jobs=N  工作线程数 (默认: CPU 核数)\n";
+    std::cout << "  --order=input|completion\n";
+    std::cout << "                  按输入顺序或完成顺序输出 (默认: input)\n\n";
     std::cout << "选择性输出选项 (可组合使用):\n";
     std::cout << "  --segments      只显示分区列表\n";
     std::cout << "  --jfif          只显示 JFIF 信息\n";
@@ -83,133 +416,103 @@ int main(int argc, char *argv[]) {
     std::cout << "  --xmp           只显示 XMP 信息\n";
     std::cout << "  --icc           只显示 ICC Profile 信息\n";
     std::cout << "  --adobe         只显示 Adobe APP14 信息\n";
-    std::cout << "  --com           只显示注释信息\n\n";
+    std::cout << "  --com           只显示注释信息\n";
+    std::cout << "  --thumbnail     只显示内嵌缩略图 (EXIF IFD1 / JFXX) 的位置\n";
+    std::cout << "  --extract-thumbnail[=DIR]\n";
+    std::cout << "                  将 JPEG 缩略图写出为 <名称>.thumb.jpg / .jfxx.jpg\n";
+    std::cout << "                  (默认写到源文件所在目录)\n";
+    std::cout << "  --tags=LIST     只提取指定的 EXIF tag，逗号分隔，支持前缀通配\n";
+    std::cout << "                  (如 Make,Model,DateTimeOriginal,GPS*)；编号写作 0x010F，\n";
+    std::cout << "                  GPS/Interop 编号需加前缀 gps:0x0002、interop:0x0001\n";
+    std::cout << "  --xmp-props=LIST\n";
+    std::cout << "                  提取的 XMP 属性，逗号分隔，前缀:名称 或 前缀:*\n";
+    std::cout << "                  (如 xmp:Rating,dc:subject,photoshop:*；默认提取常用属性)\n\n";
     std::cout << "示例:\n";
     std::cout << "  " << argv[0] << " image.jpg\n";
     std::cout << "  " << argv[0] << " image.jpg --exif\n";
     std::cout << "  " << argv[0] << " image.jpg --exif --xmp --lang=en\n";
-    return help_requested ? 0 : 1;
+    std::cout << "  " << argv[0] << " photos/ @more.txt -j 8 --sof\n";
+    std::cout << "  " << argv[0]
+              << " photos/ --exif --tags=Make,Model,DateTimeOriginal\n";
+    std::cout << "  " << argv[0] << " photos/ --format=columnar > scan.jpic\n";
+    return help_requested && !bad_args ? 0 : 1;
   }
 
   // 如果没有设置任何过滤选项，则显示所有内容
   if (!any_filter_set) {
-    show_segments = show_jfif = show_sof = show_exif = show_xmp = show_icc =
-        show_adobe = show_com = true;
+    cli.show_segments = cli.show_jfif = cli.show_sof = cli.show_exif =
+        cli.show_xmp = cli.show_icc = cli.show_adobe = cli.show_com =
+            cli.show_thumbnails = true;
   }
 
-  // 构建JPEG索引
-  IndexOptions opt;
-  opt.app_peek_bytes = 128; // 读取更多字节用于识别APP子类型
-  JpegIndexResult result = build_jpeg_index(path, opt);
+  auto run_t0 = std::chrono::steady_clock::now();
+  std::vector<std::string> paths;
+  size_t failures = collect_inputs(inputs, paths, i18n, std::cerr);
 
-  if (result.segments.empty()) {
-    std::cerr << i18n.t("error_parse") << ": " << path << "\n";
-    return 1;
-  }
-
-  std::cout << "JPEG Info: " << path << "\n";
-  std::cout << std::string(80, '=') << "\n";
+  RunStats run_stats;
+  std::mutex stats_mu;
+  const bool want_stats = stats_mode != StatsMode::Off;
 
-  // 打印分区列表
-  if (show_segments) {
-    print_segments(std::cout, result.segments, i18n);
-  }
+  // 每个文件的输出先写入独立缓冲，保证多线程下输出块完整
+  FileJob job = [&](const std::string &path, std::string &out,
+                    std::string &err) {
+    FileStats fs;
+    uint64_t allocs0 = thread_allocation_count();
+    auto t0 = std::chrono::steady_clock::now();
 
-  // 解析并打印各种元数据
-  for (const auto &seg : result.segments) {
-    std::vector<uint8_t> payload;
-
-    // JFIF (APP0)
-    if (show_jfif && seg.marker == 0xFFE0 && seg.app_subtype == "JFIF") {
-      if (load_segment_payload(path, seg, payload)) {
-        auto jfif = parse_jfif_from_app0_payload(payload);
-        if (jfif.has_value()) {
-          print_jfif_info(std::cout, jfif.value(), i18n);
-        }
-      }
-    }
+    std::ostringstream es;
+    FileStats *fsp = want_stats ? &fs : nullptr;
+    bool ok = cli.format == OutputFormat::Columnar
+                  ? export_record(path, cli, i18n, out, es, fsp)
+                  : process_file(path, cli, i18n, out, es, fsp);
+    if (cli.format == OutputFormat::Ndjson)
+      out += '\n';
+    err = es.str();
 
-    // SOF (Start of Frame)
-    if (show_sof && is_sof_marker(seg.marker)) {
-      if (load_segment_payload(path, seg, payload)) {
-        auto sof = parse_sof_payload(seg.marker, payload);
-        if (sof.has_value()) {
-          print_sof_info(std::cout, sof.value(), i18n);
-        }
-      }
+    if (want_stats) {
+      fs.total_ns = PhaseTimer::elapsed_ns(t0);
+      fs.allocations = thread_allocation_count() - allocs0;
+      std::lock_guard<std::mutex> lk(stats_mu);
+      run_stats.add_file(path, fs, ok);
     }
-
-    // EXIF (APP1)
-    if (show_exif && seg.marker == 0xFFE1 && seg.app_subtype == "EXIF") {
-      if (load_segment_payload(path, seg, payload)) {
-        auto exif = parse_exif_from_app1_payload(payload);
-        if (exif.has_value()) {
-          print_exif_info(std::cout, exif.value(), i18n);
-        }
-      }
+    return ok;
+  };
+  // --format=columnar 把各文件的记录按输出顺序汇总成列式文件写到标准输出
+  if (cli.format == OutputFormat::Columnar) {
+#if defined(_WIN32)
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    ColumnarWriter writer(std::cout);
+    MetaRecord rec;
+    failures += run_batch(
+        paths, batch, job,
+        [&](const std::string &block) {
+          if (decode_meta_record(block, rec))
+            writer.add(rec);
+        },
+        std::cerr);
+    if (!writer.finish()) {
+      std::cerr << i18n.t(Msg::ErrorWrite) << ": <stdout>\n";
+      failures++;
     }
-
-    // XMP (APP1)
-    if (show_xmp && seg.marker == 0xFFE1 && seg.app_subtype == "XMP") {
-      if (load_segment_payload(path, seg, payload)) {
-        // 默认显示完整 XML（full=true），不截断
-        auto xmp = parse_xmp_from_app1_payload(payload, true, 2048);
-        if (xmp.has_value()) {
-          print_xmp_info(std::cout, xmp.value(), i18n);
-        }
-      }
-    }
-
-    // ICC Profile (APP2)
-    if (show_icc && seg.marker == 0xFFE2 && seg.app_subtype == "ICC") {
-      if (load_segment_payload(path, seg, payload)) {
-        auto chunk = parse_icc_chunk_from_app2_payload(payload);
-        if (chunk.has_value()) {
-          // 收集所有ICC chunks并拼接
-          std::vector<IccChunk> chunks;
-          chunks.push_back(chunk.value());
-
-          // 查找其他ICC chunks
-          for (const auto &other_seg : result.segments) {
-            if (other_seg.marker == 0xFFE2 && other_seg.app_subtype == "ICC" &&
-                other_seg.marker_offset != seg.marker_offset) {
-              std::vector<uint8_t> other_payload;
-              if (load_segment_payload(path, other_seg, other_payload)) {
-                auto other_chunk =
-                    parse_icc_chunk_from_app2_payload(other_payload);
-                if (other_chunk.has_value()) {
-                  chunks.push_back(other_chunk.value());
-                }
-              }
-            }
-          }
-
-          auto icc = stitch_icc_profile(chunks);
-          if (icc.has_value()) {
-            print_icc_info(std::cout, icc.value(), i18n);
-          }
-        }
-      }
-    }
-
-    // Adobe (APP14)
-    if (show_adobe && seg.marker == 0xFFEE && seg.app_subtype == "Adobe") {
-      if (load_segment_payload(path, seg, payload)) {
-        auto adobe = parse_adobe_app14_payload(payload);
-        if (adobe.has_value()) {
-          print_adobe_info(std::cout, adobe.value(), i18n);
-        }
-      }
+  } else {
+    // --format=json 把所有文件包成一个数组
+    if (cli.format == OutputFormat::Json) {
+      batch.separator = ",\n";
+      std::cout << "[\n";
     }
+    failures += run_batch(paths, batch, job, std::cout, std::cerr);
+    if (cli.format == OutputFormat::Json)
+      std::cout << "\n]\n";
+  }
 
-    // COM (Comment)
-    if (show_com && seg.marker == 0xFFFE) {
-      if (load_segment_payload(path, seg, payload)) {
-        auto com = parse_com_payload_preview(payload, 256);
-        print_com_info(std::cout, com, i18n);
-      }
-    }
+  if (want_stats) {
+    run_stats.set_wall_ns(PhaseTimer::elapsed_ns(run_t0));
+    if (stats_mode == StatsMode::Json)
+      run_stats.print_json(std::cerr);
+    else
+      run_stats.print_text(std::cerr);
   }
 
-  return 0;
+  return failures == 0 ? 0 : 1;
 }
@@ -0,0 +1,106 @@
+// mapped_file.cpp
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool read_whole_file(const char *path, std::vector<uint8_t> &out) {
+  FILE *f = std::fopen(path, "rb");
+  if (!f)
+    return false;
+  uint8_t buf[65536];
+  size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    out.insert(out.end(), buf, buf + n);
+  bool ok = std::ferror(f) == 0;
+  std::fclose(f);
+  return ok;
+}
+
+MappedFile::MappedFile(const char *path) {
+#if defined(_WIN32)
+  HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER sz;
+    if (GetFileSizeEx(h, &sz) && sz.QuadPart > 0) {
+      HANDLE m = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (m) {
+        void *p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+        if (p) {
+          file_ = h;
+          mapping_ = m;
+          data_ = (const uint8_t *)p;
+          size_ = (uint64_t)sz.QuadPart;
+          mapped_ = ok_ = true;
+          return;
+        }
+        CloseHandle(m);
+      }
+    }
+    CloseHandle(h);
+  }
+#else
+  int fd = ::open(path, O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void *p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd,
+                       0);
+      if (p != MAP_FAILED) {
+        data_ = (const uint8_t *)p;
+        size_ = (uint64_t)st.st_size;
+        mapped_ = ok_ = true;
+        ::close(fd); // 映射建立后即可关闭 fd
+        return;
+      }
+    }
+    ::close(fd);
+  }
+#endif
+  // 空文件或不支持映射的特殊文件：整文件读入内存
+  if (read_whole_file(path, fallback_)) {
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+    ok_ = true;
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (!mapped_)
+    return;
+#if defined(_WIN32)
+  UnmapViewOfFile(data_);
+  CloseHandle((HANDLE)mapping_);
+  CloseHandle((HANDLE)file_);
+#else
+  ::munmap((void *)data_, (size_t)size_);
+#endif
+}
+
+bool MappedFile::slice(uint64_t off, uint64_t len, ByteSpan &out) const {
+  if (off > size_ || len > size_ - off)
+    return false;
+  out = ByteSpan(data_ + off, (size_t)len);
+  return true;
+}
+
+size_t MappedFile::read_at(uint64_t off, uint8_t *dst, size_t n) {
+  if (off >= size_)
+    return 0;
+  size_t take = (size_t)std::min<uint64_t>(n, size_ - off);
+  std::memcpy(dst, data_ + off, take);
+  io_.read_calls++;
+  io_.bytes_read += take;
+  return take;
+}
@@ -0,0 +1,42 @@
+// mapped_file.h
+#pragma once
+#include "byte_source.h"
+#include "jpeg_types.h"
+#include <cstdint>
+#include <vector>
+
+// 只读内存映射文件：整个文件映射一次，各段 payload 以 ByteSpan 零拷贝访问
+class MappedFile : public ByteSource {
+public:
+  explicit MappedFile(const char *path);
+  ~MappedFile() override;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool ok() const { return ok_; }
+  const uint8_t *data() const { return data_; }
+  uint64_t size() const { return size_; }
+  ByteSpan span() const { return ByteSpan(data_, (size_t)size_); }
+
+  // 取 [off, off+len) 区间，越界返回 false
+  bool slice(uint64_t off, uint64_t len, ByteSpan &out) const;
+
+  // ByteSource
+  size_t read_at(uint64_t off, uint8_t *dst, size_t n) override;
+  bool size(uint64_t &out) override {
+    out = size_;
+    return ok_;
+  }
+  ByteSpan contiguous() const override { return span(); }
+
+private:
+  const uint8_t *data_ = nullptr;
+  uint64_t size_ = 0;
+  bool ok_ = false;
+  bool mapped_ = false;
+#if defined(_WIN32)
+  void *file_ = nullptr;
+  void *mapping_ = nullptr;
+#endif
+  std::vector<uint8_t> fallback_; // 无法映射时退化为整文件读取
+};
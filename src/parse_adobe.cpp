@@ -7,7 +7,7 @@ static inline uint16_t be16(const uint8_t *p) {
 }
 
 std::optional<AdobeInfo>
-parse_adobe_app14_payload(const std::vector<uint8_t> &p) {
+parse_adobe_app14_payload(ByteSpan p) {
   // "Adobe" (5) + version(2) + flags0(2) + flags1(2) + transform(1) = 12 bytes
   // minimum after sig
   if (p.size() < 5 + 2 + 2 + 2 + 1)
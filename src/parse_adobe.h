@@ -5,4 +5,4 @@
 #include <vector>
 
 std::optional<AdobeInfo>
-parse_adobe_app14_payload(const std::vector<uint8_t> &payload);
+parse_adobe_app14_payload(ByteSpan payload);
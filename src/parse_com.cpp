@@ -1,8 +1,8 @@
 // parse_com.cpp
 #include "parse_com.h"
+#include <algorithm>
 
-ComInfo parse_com_payload_preview(const std::vector<uint8_t> &p,
-                                  size_t max_preview) {
+ComInfo parse_com_payload_preview(ByteSpan p, size_t max_preview) {
   ComInfo c;
   c.len = (uint32_t)p.size();
   size_t take = std::min(p.size(), max_preview);
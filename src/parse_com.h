@@ -4,5 +4,4 @@
 #include <optional>
 #include <vector>
 
-ComInfo parse_com_payload_preview(const std::vector<uint8_t> &payload,
-                                  size_t max_preview);
+ComInfo parse_com_payload_preview(ByteSpan payload, size_t max_preview);
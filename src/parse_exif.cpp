@@ -1,18 +1,9 @@
 #include "parse_exif.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
-#include <iomanip>
-#include <sstream>
-
-static inline uint16_t rd16(const uint8_t *p, Endian e) {
-  return (e == Endian::Little) ? (uint16_t)(p[0] | (p[1] << 8))
-                               : (uint16_t)((p[0] << 8) | p[1]);
-}
-static inline uint32_t rd32(const uint8_t *p, Endian e) {
-  if (e == Endian::Little)
-    return (uint32_t)(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));
-  return (uint32_t)((p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
-}
 
 static inline uint32_t tiff_type_size(uint16_t t) {
   switch (t) {
@@ -26,68 +17,76 @@ static inline uint32_t tiff_type_size(uint16_t t) {
     return 4; // LONG
   case 5:
     return 8; // RATIONAL
+  case 6:
+    return 1; // SBYTE
   case 7:
     return 1; // UNDEFINED
+  case 8:
+    return 2; // SSHORT
   case 9:
     return 4; // SLONG
   case 10:
     return 8; // SRATIONAL
+  case 11:
+    return 4; // FLOAT
+  case 12:
+    return 8; // DOUBLE
   default:
     return 0;
   }
 }
 
-static std::string bytes_to_ascii(const uint8_t *src, size_t n) {
-  std::string s((const char *)src, (const char *)src + n);
-  // trim at first '\0'
-  auto pos = s.find('\0');
-  if (pos != std::string::npos)
-    s.resize(pos);
-  for (auto &ch : s) {
-    unsigned char u = (unsigned char)ch;
-    if (u < 0x20 && ch != '\n' && ch != '\r' && ch != '\t')
+// 追加 ASCII 文本：截止到第一个 '\0'，不可打印的控制字符替换为 '?'
+static void append_ascii(TextWriter &w, const uint8_t *src, size_t n) {
+  std::string &out = w.str();
+  for (size_t i = 0; i < n && src[i] != '\0'; i++) {
+    char ch = (char)src[i];
+    if (src[i] < 0x20 && ch != '\n' && ch != '\r' && ch != '\t')
       ch = '?';
+    out += ch;
   }
-  return s;
 }
 
-static std::string format_rational(uint32_t num, uint32_t den) {
-  std::ostringstream oss;
-  if (den == 0) {
-    oss << num << "/0";
-    return oss.str();
+// 分数 + 小数近似（便于阅读）
+template <class T> static void format_rational(TextWriter &w, T num, T den) {
+  w << num << '/' << den;
+  if (den != 0) {
+    w << " (~";
+    w.fixed((double)num / (double)den, 6) << ')';
   }
-  // 显示分数 + 小数近似（便于阅读）
-  double v = (double)num / (double)den;
-  oss << num << "/" << den << " (~" << std::fixed << std::setprecision(6) << v
-      << ")";
-  return oss.str();
 }
 
-static bool read_value_ptr(const uint8_t *tiff, size_t tiff_len, Endian e,
-                           const uint8_t *entry, uint16_t type, uint32_t count,
-                           const uint8_t *&out_ptr, uint64_t &out_bytes) {
-  uint32_t unit = tiff_type_size(type);
-  if (unit == 0)
-    return false;
-  out_bytes = (uint64_t)unit * count;
-
-  // value_or_offset field
-  const uint8_t *val_field = entry + 8;
+// BYTE/UNDEFINED 的十六进制预览：最多 16 字节
+static void format_hex_preview(TextWriter &w, const uint8_t *ptr,
+                               uint64_t bytes) {
+  size_t take = (size_t)std::min<uint64_t>(bytes, 16);
+  w << "0x";
+  for (size_t i = 0; i < take; i++)
+    w.hex(ptr[i], 2);
+  if (bytes > take)
+    w << "... (" << bytes << " bytes)";
+}
 
-  if (out_bytes <= 4) {
-    out_ptr = val_field; // inline
-    return true;
+// 定位条目值数据：<=4 字节时内联在条目的 value_or_offset 字段中
+static void locate_value(size_t tiff_len, size_t entry_off, ExifTag &tg) {
+  uint32_t unit = tiff_type_size(tg.type);
+  uint64_t bytes = (uint64_t)unit * tg.count;
+  if (unit == 0)
+    return;
+  if (bytes <= 4) {
+    tg.data_offset = (uint32_t)(entry_off + 8);
+    tg.data_size = (uint32_t)bytes;
+    return;
   }
-  uint32_t off = rd32(val_field, e);
-  if ((uint64_t)off + out_bytes > tiff_len)
-    return false;
-  out_ptr = tiff + off;
-  return true;
+  if ((uint64_t)tg.value_or_offset + bytes > tiff_len)
+    return;
+  tg.data_offset = tg.value_or_offset;
+  tg.data_size = (uint32_t)bytes;
 }
 
 // EXIF 枚举值映射函数
-static std::string map_orientation(uint16_t val) {
+// 以下名称表未知值返回空串，由 enum_mapper 输出数字
+static std::string_view map_orientation(uint16_t val) {
   switch (val) {
   case 1:
     return "Horizontal (normal)";
@@ -106,11 +105,24 @@ static std::string map_orientation(uint16_t val) {
   case 8:
     return "Rotate 270 CW";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_resolution_unit(uint16_t val) {
+static std::string_view map_compression(uint16_t val) {
+  switch (val) {
+  case 1:
+    return "Uncompressed";
+  case 6:
+    return "JPEG (old-style)";
+  case 7:
+    return "JPEG";
+  default:
+    return {};
+  }
+}
+
+static std::string_view map_resolution_unit(uint16_t val) {
   switch (val) {
   case 1:
     return "None";
@@ -119,11 +131,11 @@ static std::string map_resolution_unit(uint16_t val) {
   case 3:
     return "cm";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_exposure_program(uint16_t val) {
+static std::string_view map_exposure_program(uint16_t val) {
   switch (val) {
   case 0:
     return "Not Defined";
@@ -144,11 +156,11 @@ static std::string map_exposure_program(uint16_t val) {
   case 8:
     return "Landscape";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_metering_mode(uint16_t val) {
+static std::string_view map_metering_mode(uint16_t val) {
   switch (val) {
   case 0:
     return "Unknown";
@@ -167,55 +179,52 @@ static std::string map_metering_mode(uint16_t val) {
   case 255:
     return "Other";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_flash(uint16_t val) {
-  std::ostringstream oss;
+static void map_flash(TextWriter &w, uint16_t val) {
   bool fired = (val & 0x01) != 0;
 
   if (!fired) {
-    oss << "Off, Did not fire";
+    w << "Off, Did not fire";
   } else {
-    oss << "Fired";
+    w << "Fired";
 
     // Return light detection
     uint8_t return_light = (val >> 1) & 0x03;
     if (return_light == 2)
-      oss << ", Return detected";
+      w << ", Return detected";
     else if (return_light == 3)
-      oss << ", Return not detected";
+      w << ", Return not detected";
 
     // Flash mode
     uint8_t mode = (val >> 3) & 0x03;
     if (mode == 1)
-      oss << ", Compulsory flash firing";
+      w << ", Compulsory flash firing";
     else if (mode == 2)
-      oss << ", Compulsory flash suppression";
+      w << ", Compulsory flash suppression";
     else if (mode == 3)
-      oss << ", Auto mode";
+      w << ", Auto mode";
 
     // Red-eye
     if (val & 0x40)
-      oss << ", Red-eye reduction";
+      w << ", Red-eye reduction";
   }
-
-  return oss.str();
 }
 
-static std::string map_color_space(uint16_t val) {
+static std::string_view map_color_space(uint16_t val) {
   switch (val) {
   case 1:
     return "sRGB";
   case 65535:
     return "Uncalibrated";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_sensing_method(uint16_t val) {
+static std::string_view map_sensing_method(uint16_t val) {
   switch (val) {
   case 1:
     return "Not defined";
@@ -232,11 +241,11 @@ static std::string map_sensing_method(uint16_t val) {
   case 8:
     return "Color sequential linear";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_scene_capture_type(uint16_t val) {
+static std::string_view map_scene_capture_type(uint16_t val) {
   switch (val) {
   case 0:
     return "Standard";
@@ -247,11 +256,11 @@ static std::string map_scene_capture_type(uint16_t val) {
   case 3:
     return "Night";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_light_source(uint16_t val) {
+static std::string_view map_light_source(uint16_t val) {
   switch (val) {
   case 0:
     return "Unknown";
@@ -288,11 +297,11 @@ static std::string map_light_source(uint16_t val) {
   case 255:
     return "Other";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_exposure_mode(uint16_t val) {
+static std::string_view map_exposure_mode(uint16_t val) {
   switch (val) {
   case 0:
     return "Auto";
@@ -301,33 +310,33 @@ static std::string map_exposure_mode(uint16_t val) {
   case 2:
     return "Auto bracket";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_white_balance(uint16_t val) {
+static std::string_view map_white_balance(uint16_t val) {
   switch (val) {
   case 0:
     return "Auto";
   case 1:
     return "Manual";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_custom_rendered(uint16_t val) {
+static std::string_view map_custom_rendered(uint16_t val) {
   switch (val) {
   case 0:
     return "Normal";
   case 1:
     return "Custom";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string map_contrast_saturation_sharpness(uint16_t val) {
+static std::string_view map_contrast_saturation_sharpness(uint16_t val) {
   switch (val) {
   case 0:
     return "Normal";
@@ -336,179 +345,343 @@ static std::string map_contrast_saturation_sharpness(uint16_t val) {
   case 2:
     return "High";
   default:
-    return std::to_string(val);
+    return {};
   }
 }
 
-static std::string format_value(const uint8_t *tiff, size_t tiff_len, Endian e,
-                                const uint8_t *entry, uint16_t type,
-                                uint32_t count, uint16_t tag) {
-  const uint8_t *ptr = nullptr;
-  uint64_t bytes = 0;
-  if (!read_value_ptr(tiff, tiff_len, e, entry, type, count, ptr, bytes))
-    return "";
+// 名称表形式的枚举映射：未知值输出数字
+template <std::string_view (*Name)(uint16_t)>
+static void enum_mapper(TextWriter &w, uint16_t val) {
+  std::string_view name = Name(val);
+  if (name.empty())
+    w << val;
+  else
+    w << name;
+}
+
+// tag 字典：按 (ns, id) 排序，编译期校验顺序并生成按名称排序的索引
+static constexpr ExifTagInfo kExifTags[] = {
+    // IFD0 / EXIF IFD
+    {0x0100, ExifNamespace::Tiff, 0, "ImageWidth", nullptr},
+    {0x0101, ExifNamespace::Tiff, 0, "ImageLength", nullptr},
+    {0x0103, ExifNamespace::Tiff, 3, "Compression", enum_mapper<map_compression>},
+    {0x010E, ExifNamespace::Tiff, 2, "ImageDescription", nullptr},
+    {0x010F, ExifNamespace::Tiff, 2, "Make", nullptr},
+    {0x0110, ExifNamespace::Tiff, 2, "Model", nullptr},
+    {0x0112, ExifNamespace::Tiff, 3, "Orientation", enum_mapper<map_orientation>},
+    {0x011A, ExifNamespace::Tiff, 5, "XResolution", nullptr},
+    {0x011B, ExifNamespace::Tiff, 5, "YResolution", nullptr},
+    {0x0128, ExifNamespace::Tiff, 3, "ResolutionUnit", enum_mapper<map_resolution_unit>},
+    {0x0131, ExifNamespace::Tiff, 2, "Software", nullptr},
+    {0x0132, ExifNamespace::Tiff, 2, "DateTime", nullptr},
+    {0x013B, ExifNamespace::Tiff, 2, "Artist", nullptr},
+    {0x013E, ExifNamespace::Tiff, 5, "WhitePoint", nullptr},
+    {0x013F, ExifNamespace::Tiff, 5, "PrimaryChromaticities", nullptr},
+    {0x0201, ExifNamespace::Tiff, 4, "JPEGInterchangeFormat", nullptr},
+    {0x0202, ExifNamespace::Tiff, 4, "JPEGInterchangeFormatLength", nullptr},
+    {0x0211, ExifNamespace::Tiff, 5, "YCbCrCoefficients", nullptr},
+    {0x0212, ExifNamespace::Tiff, 3, "YCbCrSubSampling", nullptr},
+    {0x0213, ExifNamespace::Tiff, 3, "YCbCrPositioning", nullptr},
+    {0x0214, ExifNamespace::Tiff, 5, "ReferenceBlackWhite", nullptr},
+    {0x8298, ExifNamespace::Tiff, 2, "Copyright", nullptr},
+    {0x829A, ExifNamespace::Tiff, 5, "ExposureTime", nullptr},
+    {0x829D, ExifNamespace::Tiff, 5, "FNumber", nullptr},
+    {0x8769, ExifNamespace::Tiff, 4, "ExifIFDPointer", nullptr},
+    {0x8822, ExifNamespace::Tiff, 3, "ExposureProgram", enum_mapper<map_exposure_program>},
+    {0x8824, ExifNamespace::Tiff, 2, "SpectralSensitivity", nullptr},
+    {0x8825, ExifNamespace::Tiff, 4, "GPSInfoIFDPointer", nullptr},
+    {0x8827, ExifNamespace::Tiff, 3, "ISO", nullptr},
+    {0x8828, ExifNamespace::Tiff, 7, "OECF", nullptr},
+    {0x8830, ExifNamespace::Tiff, 3, "SensitivityType", nullptr},
+    {0x8832, ExifNamespace::Tiff, 4, "RecommendedExposureIndex", nullptr},
+    {0x9000, ExifNamespace::Tiff, 7, "ExifVersion", nullptr},
+    {0x9003, ExifNamespace::Tiff, 2, "DateTimeOriginal", nullptr},
+    {0x9004, ExifNamespace::Tiff, 2, "DateTimeDigitized", nullptr},
+    {0x9010, ExifNamespace::Tiff, 2, "OffsetTime", nullptr},
+    {0x9011, ExifNamespace::Tiff, 2, "OffsetTimeOriginal", nullptr},
+    {0x9012, ExifNamespace::Tiff, 2, "OffsetTimeDigitized", nullptr},
+    {0x9101, ExifNamespace::Tiff, 7, "ComponentsConfiguration", nullptr},
+    {0x9102, ExifNamespace::Tiff, 5, "CompressedBitsPerPixel", nullptr},
+    {0x9201, ExifNamespace::Tiff, 10, "ShutterSpeedValue", nullptr},
+    {0x9202, ExifNamespace::Tiff, 5, "ApertureValue", nullptr},
+    {0x9203, ExifNamespace::Tiff, 10, "BrightnessValue", nullptr},
+    {0x9204, ExifNamespace::Tiff, 10, "ExposureBiasValue", nullptr},
+    {0x9205, ExifNamespace::Tiff, 5, "MaxApertureValue", nullptr},
+    {0x9206, ExifNamespace::Tiff, 5, "SubjectDistance", nullptr},
+    {0x9207, ExifNamespace::Tiff, 3, "MeteringMode", enum_mapper<map_metering_mode>},
+    {0x9208, ExifNamespace::Tiff, 3, "LightSource", enum_mapper<map_light_source>},
+    {0x9209, ExifNamespace::Tiff, 3, "Flash", map_flash},
+    {0x920A, ExifNamespace::Tiff, 5, "FocalLength", nullptr},
+    {0x9214, ExifNamespace::Tiff, 3, "SubjectArea", nullptr},
+    {0x927C, ExifNamespace::Tiff, 7, "MakerNote", nullptr},
+    {0x9286, ExifNamespace::Tiff, 7, "UserComment", nullptr},
+    {0x9290, ExifNamespace::Tiff, 2, "SubSecTime", nullptr},
+    {0x9291, ExifNamespace::Tiff, 2, "SubSecTimeOriginal", nullptr},
+    {0x9292, ExifNamespace::Tiff, 2, "SubSecTimeDigitized", nullptr},
+    {0xA000, ExifNamespace::Tiff, 7, "FlashpixVersion", nullptr},
+    {0xA001, ExifNamespace::Tiff, 3, "ColorSpace", enum_mapper<map_color_space>},
+    {0xA002, ExifNamespace::Tiff, 0, "PixelXDimension", nullptr},
+    {0xA003, ExifNamespace::Tiff, 0, "PixelYDimension", nullptr},
+    {0xA004, ExifNamespace::Tiff, 2, "RelatedSoundFile", nullptr},
+    {0xA005, ExifNamespace::Tiff, 4, "InteroperabilityIFDPointer", nullptr},
+    {0xA20B, ExifNamespace::Tiff, 5, "FlashEnergy", nullptr},
+    {0xA20C, ExifNamespace::Tiff, 7, "SpatialFrequencyResponse", nullptr},
+    {0xA20E, ExifNamespace::Tiff, 5, "FocalPlaneXResolution", nullptr},
+    {0xA20F, ExifNamespace::Tiff, 5, "FocalPlaneYResolution", nullptr},
+    {0xA210, ExifNamespace::Tiff, 3, "FocalPlaneResolutionUnit", nullptr},
+    {0xA214, ExifNamespace::Tiff, 3, "SubjectLocation", nullptr},
+    {0xA215, ExifNamespace::Tiff, 5, "ExposureIndex", nullptr},
+    {0xA217, ExifNamespace::Tiff, 3, "SensingMethod", enum_mapper<map_sensing_method>},
+    {0xA300, ExifNamespace::Tiff, 7, "FileSource", nullptr},
+    {0xA301, ExifNamespace::Tiff, 7, "SceneType", nullptr},
+    {0xA302, ExifNamespace::Tiff, 7, "CFAPattern", nullptr},
+    {0xA401, ExifNamespace::Tiff, 3, "CustomRendered", enum_mapper<map_custom_rendered>},
+    {0xA402, ExifNamespace::Tiff, 3, "ExposureMode", enum_mapper<map_exposure_mode>},
+    {0xA403, ExifNamespace::Tiff, 3, "WhiteBalance", enum_mapper<map_white_balance>},
+    {0xA404, ExifNamespace::Tiff, 5, "DigitalZoomRatio", nullptr},
+    {0xA405, ExifNamespace::Tiff, 3, "FocalLengthIn35mmFilm", nullptr},
+    {0xA406, ExifNamespace::Tiff, 3, "SceneCaptureType", enum_mapper<map_scene_capture_type>},
+    {0xA407, ExifNamespace::Tiff, 3, "GainControl", nullptr},
+    {0xA408, ExifNamespace::Tiff, 3, "Contrast", enum_mapper<map_contrast_saturation_sharpness>},
+    {0xA409, ExifNamespace::Tiff, 3, "Saturation", enum_mapper<map_contrast_saturation_sharpness>},
+    {0xA40A, ExifNamespace::Tiff, 3, "Sharpness", enum_mapper<map_contrast_saturation_sharpness>},
+    {0xA40B, ExifNamespace::Tiff, 7, "DeviceSettingDescription", nullptr},
+    {0xA40C, ExifNamespace::Tiff, 3, "SubjectDistanceRange", nullptr},
+    {0xA420, ExifNamespace::Tiff, 2, "ImageUniqueID", nullptr},
+    {0xA430, ExifNamespace::Tiff, 2, "CameraOwnerName", nullptr},
+    {0xA431, ExifNamespace::Tiff, 2, "BodySerialNumber", nullptr},
+    {0xA432, ExifNamespace::Tiff, 5, "LensSpecification", nullptr},
+    {0xA433, ExifNamespace::Tiff, 2, "LensMake", nullptr},
+    {0xA434, ExifNamespace::Tiff, 2, "LensModel", nullptr},
+    {0xA435, ExifNamespace::Tiff, 2, "LensSerialNumber", nullptr},
+    // GPS IFD
+    {0x0000, ExifNamespace::Gps, 1, "GPSVersionID", nullptr},
+    {0x0001, ExifNamespace::Gps, 2, "GPSLatitudeRef", nullptr},
+    {0x0002, ExifNamespace::Gps, 5, "GPSLatitude", nullptr},
+    {0x0003, ExifNamespace::Gps, 2, "GPSLongitudeRef", nullptr},
+    {0x0004, ExifNamespace::Gps, 5, "GPSLongitude", nullptr},
+    {0x0005, ExifNamespace::Gps, 1, "GPSAltitudeRef", nullptr},
+    {0x0006, ExifNamespace::Gps, 5, "GPSAltitude", nullptr},
+    {0x0007, ExifNamespace::Gps, 5, "GPSTimeStamp", nullptr},
+    {0x0008, ExifNamespace::Gps, 2, "GPSSatellites", nullptr},
+    {0x0009, ExifNamespace::Gps, 2, "GPSStatus", nullptr},
+    {0x000A, ExifNamespace::Gps, 2, "GPSMeasureMode", nullptr},
+    {0x000B, ExifNamespace::Gps, 5, "GPSDOP", nullptr},
+    {0x000C, ExifNamespace::Gps, 2, "GPSSpeedRef", nullptr},
+    {0x000D, ExifNamespace::Gps, 5, "GPSSpeed", nullptr},
+    {0x000E, ExifNamespace::Gps, 2, "GPSTrackRef", nullptr},
+    {0x000F, ExifNamespace::Gps, 5, "GPSTrack", nullptr},
+    {0x0010, ExifNamespace::Gps, 2, "GPSImgDirectionRef", nullptr},
+    {0x0011, ExifNamespace::Gps, 5, "GPSImgDirection", nullptr},
+    {0x0012, ExifNamespace::Gps, 2, "GPSMapDatum", nullptr},
+    {0x0013, ExifNamespace::Gps, 2, "GPSDestLatitudeRef", nullptr},
+    {0x0014, ExifNamespace::Gps, 5, "GPSDestLatitude", nullptr},
+    {0x0015, ExifNamespace::Gps, 2, "GPSDestLongitudeRef", nullptr},
+    {0x0016, ExifNamespace::Gps, 5, "GPSDestLongitude", nullptr},
+    {0x0017, ExifNamespace::Gps, 2, "GPSDestBearingRef", nullptr},
+    {0x0018, ExifNamespace::Gps, 5, "GPSDestBearing", nullptr},
+    {0x0019, ExifNamespace::Gps, 2, "GPSDestDistanceRef", nullptr},
+    {0x001A, ExifNamespace::Gps, 5, "GPSDestDistance", nullptr},
+    {0x001B, ExifNamespace::Gps, 7, "GPSProcessingMethod", nullptr},
+    {0x001C, ExifNamespace::Gps, 7, "GPSAreaInformation", nullptr},
+    {0x001D, ExifNamespace::Gps, 2, "GPSDateStamp", nullptr},
+    {0x001E, ExifNamespace::Gps, 3, "GPSDifferential", nullptr},
+    {0x001F, ExifNamespace::Gps, 5, "GPSHPositioningError", nullptr},
+    // Interoperability IFD
+    {0x0001, ExifNamespace::Interop, 2, "InteroperabilityIndex", nullptr},
+    {0x0002, ExifNamespace::Interop, 7, "InteroperabilityVersion", nullptr},
+    {0x1000, ExifNamespace::Interop, 2, "RelatedImageFileFormat", nullptr},
+    {0x1001, ExifNamespace::Interop, 0, "RelatedImageWidth", nullptr},
+    {0x1002, ExifNamespace::Interop, 0, "RelatedImageLength", nullptr},
+};
+static constexpr size_t kExifTagCount = sizeof(kExifTags) / sizeof(kExifTags[0]);
+
+static constexpr bool tag_key_less(const ExifTagInfo &a, const ExifTagInfo &b) {
+  return a.ns != b.ns ? a.ns < b.ns : a.id < b.id;
+}
+
+static constexpr bool exif_tags_sorted() {
+  for (size_t i = 1; i < kExifTagCount; i++)
+    if (!tag_key_less(kExifTags[i - 1], kExifTags[i]))
+      return false;
+  return true;
+}
+static_assert(exif_tags_sorted(), "kExifTags must be sorted by (ns, id)");
 
-  std::ostringstream oss;
-  switch (type) {
+// 名称索引：编译期插入排序
+static constexpr std::array<uint16_t, kExifTagCount> make_name_index() {
+  std::array<uint16_t, kExifTagCount> idx{};
+  for (size_t i = 0; i < kExifTagCount; i++)
+    idx[i] = (uint16_t)i;
+  for (size_t i = 1; i < kExifTagCount; i++) {
+    uint16_t cur = idx[i];
+    size_t j = i;
+    while (j > 0 && kExifTags[cur].name < kExifTags[idx[j - 1]].name) {
+      idx[j] = idx[j - 1];
+      j--;
+    }
+    idx[j] = cur;
+  }
+  return idx;
+}
+static constexpr auto kExifTagsByName = make_name_index();
+
+static constexpr bool exif_names_unique() {
+  for (size_t i = 1; i < kExifTagCount; i++)
+    if (kExifTags[kExifTagsByName[i - 1]].name ==
+        kExifTags[kExifTagsByName[i]].name)
+      return false;
+  return true;
+}
+static_assert(exif_names_unique(), "EXIF tag names must be unique");
+
+const ExifTagInfo *exif_tag_info(uint16_t id, ExifNamespace ns) {
+  ExifTagInfo key{id, ns, 0, {}, nullptr};
+  const ExifTagInfo *end = kExifTags + kExifTagCount;
+  const ExifTagInfo *it = std::lower_bound(kExifTags, end, key, tag_key_less);
+  return it != end && it->ns == ns && it->id == id ? it : nullptr;
+}
+
+// 名称索引中第一个 name >= key 的位置
+static size_t name_lower_bound(std::string_view key) {
+  auto it = std::lower_bound(
+      kExifTagsByName.begin(), kExifTagsByName.end(), key,
+      [](uint16_t i, std::string_view k) { return kExifTags[i].name < k; });
+  return (size_t)(it - kExifTagsByName.begin());
+}
+
+const ExifTagInfo *exif_tag_by_name(std::string_view name) {
+  size_t i = name_lower_bound(name);
+  if (i < kExifTagCount && kExifTags[kExifTagsByName[i]].name == name)
+    return &kExifTags[kExifTagsByName[i]];
+  return nullptr;
+}
+
+size_t exif_tags_with_prefix(std::string_view prefix,
+                             std::vector<const ExifTagInfo *> &out) {
+  size_t n = 0;
+  for (size_t i = name_lower_bound(prefix); i < kExifTagCount; i++, n++) {
+    const ExifTagInfo &t = kExifTags[kExifTagsByName[i]];
+    if (t.name.substr(0, prefix.size()) != prefix)
+      break;
+    out.push_back(&t);
+  }
+  return n;
+}
+
+std::string_view exif_tag_name(uint16_t tag, ExifNamespace ns) {
+  const ExifTagInfo *info = exif_tag_info(tag, ns);
+  return info ? info->name : std::string_view();
+}
+
+// 数组读取按字节序实例化；视图已保证 bytes == 单元大小 * count
+template <Endian E>
+static void format_value_t(TextWriter &w, const ExifValueView &v, uint16_t tag,
+                           ExifNamespace ns) {
+  const uint8_t *ptr = v.bytes().data();
+  uint64_t bytes = v.bytes().size();
+  uint32_t count = v.count();
+
+  switch (v.type()) {
   case 2: { // ASCII
     // ASCII 字段可能不以 \0 结尾（如 ExifVersion, FlashpixVersion）
     // 注意：count<=4 时，数据内联在 value_or_offset 字段中（ptr 指向它）
-    std::string s;
-
-    // 读取所有字节
-    for (size_t i = 0; i < (size_t)bytes; i++) {
-      char ch = (char)ptr[i];
-      if (ch == '\0')
-        break; // 遇到 null 终止符就停止
-      s += ch;
-    }
-
-    // 清理不可打印字符
-    for (auto &ch : s) {
-      unsigned char u = (unsigned char)ch;
-      if (u < 0x20 && ch != '\n' && ch != '\r' && ch != '\t')
-        ch = '?';
-    }
+    size_t before = w.str().size();
+    append_ascii(w, ptr, (size_t)bytes);
 
     // GPS Ref 字段：如果为空，显示 "Unknown"
-    if (s.empty() && (tag == 0x0001 || tag == 0x0003 || tag == 0x000C ||
-                      tag == 0x0010 || tag == 0x0017)) {
-      return "Unknown";
-    }
-
-    return s;
+    if (w.str().size() == before && ns == ExifNamespace::Gps &&
+        (tag == 0x0001 || tag == 0x0003 || tag == 0x000C || tag == 0x0010 ||
+         tag == 0x0017))
+      w << "Unknown";
+    return;
   }
   case 1: { // BYTE
     // 对于某些特殊 tag（如 GPSVersionID），显示为点分十进制
-    if (tag == 0x0000 && count == 4) { // GPSVersionID
-      oss << (int)ptr[0] << "." << (int)ptr[1] << "." << (int)ptr[2] << "."
-          << (int)ptr[3];
-      return oss.str();
+    if (ns == ExifNamespace::Gps && tag == 0x0000 &&
+        count == 4) { // GPSVersionID
+      w << ptr[0] << '.' << ptr[1] << '.' << ptr[2] << '.' << ptr[3];
+      return;
     }
     // 其他 BYTE 数组：显示为十六进制预览
-    size_t take = (size_t)std::min<uint64_t>(bytes, 16);
-    oss << "0x";
-    for (size_t i = 0; i < take; i++) {
-      oss << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
-          << (int)ptr[i];
-    }
-    if (bytes > take)
-      oss << "... (" << bytes << " bytes)";
-    return oss.str();
+    format_hex_preview(w, ptr, bytes);
+    return;
   }
   case 3: { // SHORT
     // 对特定 tag 应用枚举值映射
     if (count == 1) {
-      uint16_t v = rd16(ptr, e);
+      uint16_t val = exif_load16<E>(ptr);
 
       // 应用枚举值映射
-      switch (tag) {
-      case 0x0112: // Orientation
-        return map_orientation(v);
-      case 0x0128: // ResolutionUnit
-        return map_resolution_unit(v);
-      case 0x8822: // ExposureProgram
-        return map_exposure_program(v);
-      case 0x9207: // MeteringMode
-        return map_metering_mode(v);
-      case 0x9209: // Flash
-        return map_flash(v);
-      case 0xA001: // ColorSpace
-        return map_color_space(v);
-      case 0xA217: // SensingMethod
-        return map_sensing_method(v);
-      case 0xA406: // SceneCaptureType
-        return map_scene_capture_type(v);
-      case 0x9208: // LightSource
-        return map_light_source(v);
-      case 0xA402: // ExposureMode
-        return map_exposure_mode(v);
-      case 0xA403: // WhiteBalance
-        return map_white_balance(v);
-      case 0xA401: // CustomRendered
-        return map_custom_rendered(v);
-      case 0xA408: // Contrast
-      case 0xA409: // Saturation
-      case 0xA40A: // Sharpness
-        return map_contrast_saturation_sharpness(v);
-      default:
-        // 对于其他 tag，显示原始值
-        return std::to_string(v);
-      }
+      const ExifTagInfo *info = exif_tag_info(tag, ns);
+      if (info && info->mapper)
+        info->mapper(w, val);
+      else
+        w << val;
+      return;
     }
 
     // 对于数组，显示前几个
     uint32_t n = std::min<uint32_t>(count, 8);
     for (uint32_t i = 0; i < n; i++) {
-      uint16_t v = rd16(ptr + i * 2, e);
       if (i)
-        oss << ", ";
-      oss << v;
+        w << ", ";
+      w << exif_load16<E>(ptr + i * 2);
     }
     if (count > n)
-      oss << ", ...";
-    return oss.str();
+      w << ", ...";
+    return;
   }
   case 4: { // LONG
     uint32_t n = std::min<uint32_t>(count, 8);
     for (uint32_t i = 0; i < n; i++) {
-      uint32_t v = rd32(ptr + i * 4, e);
       if (i)
-        oss << ", ";
-      oss << v;
+        w << ", ";
+      w << exif_load32<E>(ptr + i * 4);
     }
     if (count > n)
-      oss << ", ...";
-    return oss.str();
+      w << ", ...";
+    return;
   }
   case 5: { // RATIONAL
     uint32_t n = std::min<uint32_t>(count, 4);
     for (uint32_t i = 0; i < n; i++) {
-      uint32_t num = rd32(ptr + i * 8 + 0, e);
-      uint32_t den = rd32(ptr + i * 8 + 4, e);
       if (i)
-        oss << ", ";
-      oss << format_rational(num, den);
+        w << ", ";
+      format_rational(w, exif_load32<E>(ptr + i * 8),
+                      exif_load32<E>(ptr + i * 8 + 4));
     }
     if (count > n)
-      oss << ", ...";
-    return oss.str();
+      w << ", ...";
+    return;
   }
   case 9: { // SLONG (signed long)
     uint32_t n = std::min<uint32_t>(count, 8);
     for (uint32_t i = 0; i < n; i++) {
-      int32_t v = (int32_t)rd32(ptr + i * 4, e);
       if (i)
-        oss << ", ";
-      oss << v;
+        w << ", ";
+      w << (int32_t)exif_load32<E>(ptr + i * 4);
     }
     if (count > n)
-      oss << ", ...";
-    return oss.str();
+      w << ", ...";
+    return;
   }
   case 10: { // SRATIONAL (signed rational)
     uint32_t n = std::min<uint32_t>(count, 4);
     for (uint32_t i = 0; i < n; i++) {
-      int32_t num = (int32_t)rd32(ptr + i * 8 + 0, e);
-      int32_t den = (int32_t)rd32(ptr + i * 8 + 4, e);
       if (i)
-        oss << ", ";
-      if (den == 0) {
-        oss << num << "/0";
-      } else {
-        double v = (double)num / (double)den;
-        oss << num << "/" << den << " (~" << std::fixed << std::setprecision(6)
-            << v << ")";
-      }
+        w << ", ";
+      format_rational(w, (int32_t)exif_load32<E>(ptr + i * 8),
+                      (int32_t)exif_load32<E>(ptr + i * 8 + 4));
     }
     if (count > n)
-      oss << ", ...";
-    return oss.str();
+      w << ", ...";
+    return;
   }
   case 7: { // UNDEFINED
     // 对于 ComponentsConfiguration (0x9101)，映射为可读名称
     if (tag == 0x9101 && count == 4) {
-      auto comp_name = [](uint8_t c) -> std::string {
+      auto comp_name = [](uint8_t c) -> std::string_view {
         switch (c) {
         case 0:
           return "-";
@@ -528,100 +701,289 @@ static std::string format_value(const uint8_t *tiff, size_t tiff_len, Endian e,
           return "?";
         }
       };
-      oss << comp_name(ptr[0]) << ", " << comp_name(ptr[1]) << ", "
-          << comp_name(ptr[2]) << ", " << comp_name(ptr[3]);
-      return oss.str();
+      w << comp_name(ptr[0]) << ", " << comp_name(ptr[1]) << ", "
+        << comp_name(ptr[2]) << ", " << comp_name(ptr[3]);
+      return;
     }
     // 对于 UserComment (0x9286)，前 8 字节是编码标识
     if (tag == 0x9286 && bytes > 8) {
-      std::string encoding((const char *)ptr, 8);
+      std::string_view encoding((const char *)ptr, 8);
       // 常见编码: "ASCII\0\0\0", "JIS\0\0\0\0\0", "UNICODE\0"
-      if (encoding.find("ASCII") == 0) {
-        return "ASCII: " + bytes_to_ascii(ptr + 8, (size_t)(bytes - 8));
-      } else if (encoding.find("UNICODE") == 0) {
-        return "UNICODE: (binary data, " + std::to_string(bytes - 8) +
-               " bytes)";
+      if (encoding.compare(0, 5, "ASCII") == 0) {
+        w << "ASCII: ";
+        append_ascii(w, ptr + 8, (size_t)(bytes - 8));
+      } else if (encoding.compare(0, 7, "UNICODE") == 0) {
+        w << "UNICODE: (binary data, " << bytes - 8 << " bytes)";
       } else {
-        return "Unknown encoding: " + encoding;
+        w << "Unknown encoding: " << encoding;
       }
+      return;
     }
     // 对于 MakerNote (0x927C)，只显示摘要
     if (tag == 0x927C) {
-      return "MakerNote (" + std::to_string(bytes) + " bytes, vendor-specific)";
+      w << "MakerNote (" << bytes << " bytes, vendor-specific)";
+      return;
     }
     // 对于 ExifVersion/FlashpixVersion，如果是 4 字节，尝试作为 ASCII
-    if ((tag == 0x9000 || tag == 0xA000) && bytes == 4) {
-      return bytes_to_ascii(ptr, 4);
+    // InteroperabilityVersion 同样是 4 字节 ASCII
+    if (((ns == ExifNamespace::Tiff && (tag == 0x9000 || tag == 0xA000)) ||
+         (ns == ExifNamespace::Interop && tag == 0x0002)) &&
+        bytes == 4) {
+      append_ascii(w, ptr, 4);
+      return;
     }
     // 其他 UNDEFINED：十六进制预览
-    size_t take = (size_t)std::min<uint64_t>(bytes, 16);
-    oss << "0x";
-    for (size_t i = 0; i < take; i++) {
-      oss << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
-          << (int)ptr[i];
-    }
-    if (bytes > take)
-      oss << "... (" << bytes << " bytes)";
-    return oss.str();
+    format_hex_preview(w, ptr, bytes);
+    return;
   }
   default:
-    return "";
+    return;
+  }
+}
+
+static void format_value(TextWriter &w, const ExifValueView &v, uint16_t tag,
+                         ExifNamespace ns) {
+  if (!v.valid())
+    return;
+  if (v.endian() == Endian::Little)
+    format_value_t<Endian::Little>(w, v, tag, ns);
+  else
+    format_value_t<Endian::Big>(w, v, tag, ns);
+}
+
+// 乱序或重复 tag 的 IFD：按 tag 稳定排序，重复时保留最后一个
+static void normalize_ifd(ExifIfd &ifd) {
+  auto &v = ifd.tags;
+  std::stable_sort(v.begin(), v.end(), [](const ExifTag &a, const ExifTag &b) {
+    return a.tag < b.tag;
+  });
+  size_t w = 0;
+  for (size_t r = 0; r < v.size(); r++) {
+    if (r + 1 < v.size() && v[r + 1].tag == v[r].tag)
+      continue;
+    v[w++] = v[r];
   }
+  v.resize(w);
 }
 
-static bool parse_ifd(const uint8_t *tiff, size_t tiff_len, Endian e,
-                      uint32_t ifd_off, ExifIfd &out) {
+// 单次 IFD 遍历的选择条件；want 为 nullptr 时保留全部条目
+struct IfdScan {
+  const std::vector<uint16_t> *want = nullptr;
+  // want 中各 tag 是否已找到；同一个 IfdScan 依次用于 IFD0、EXIF 与 IFD1，
+  // 重复出现的 tag 只在第一次命中时计数
+  std::vector<uint8_t> found;
+  size_t remaining = 0; // 尚未找到的 wanted tag 数
+  // 过滤模式下提前结束前还必须找到的子 IFD 指针
+  bool need_exif_ptr = false;
+  bool need_gps_ptr = false;
+  bool need_interop_ptr = false;
+
+  uint32_t exif_ptr = 0;    // 0x8769 ExifIFDPointer
+  uint32_t gps_ptr = 0;     // 0x8825 GPSInfoIFDPointer
+  uint32_t interop_ptr = 0; // 0xA005 InteroperabilityIFDPointer
+  uint32_t next_ifd = 0;    // 条目之后的下一个 IFD 链接
+
+  bool pointers_pending() const {
+    return (need_exif_ptr && exif_ptr == 0) || (need_gps_ptr && gps_ptr == 0) ||
+           (need_interop_ptr && interop_ptr == 0);
+  }
+};
+
+// 整个 TIFF 块共享的遍历状态：已访问的 IFD 区间（防止循环与重叠）和预算
+struct IfdBudget {
+  const ExifLimits &limits;
+  std::vector<std::pair<uint32_t, uint32_t>> visited; // [begin, end)
+  uint32_t entries = 0;
+  uint64_t value_bytes = 0;
+  bool truncated = false;
+
+  explicit IfdBudget(const ExifLimits &l) : limits(l) {}
+
+  // 登记一个 IFD；与已访问区间重叠或超出 IFD 数量预算时拒绝
+  bool enter(uint32_t begin, uint32_t end) {
+    if (visited.size() >= limits.max_ifds) {
+      truncated = true;
+      return false;
+    }
+    for (const auto &r : visited) {
+      if (begin < r.second && r.first < end) {
+        truncated = true;
+        return false;
+      }
+    }
+    visited.emplace_back(begin, end);
+    return true;
+  }
+};
+
+template <Endian E>
+static bool parse_ifd(const uint8_t *tiff, size_t tiff_len, uint32_t ifd_off,
+                      ExifIfd &out, IfdScan &scan, IfdBudget &budget) {
   if ((uint64_t)ifd_off + 2 > tiff_len)
     return false;
-  uint16_t n = rd16(tiff + ifd_off, e);
+  uint16_t n = exif_load16<E>(tiff + ifd_off);
   uint64_t base = (uint64_t)ifd_off + 2;
   uint64_t need = base + (uint64_t)n * 12 + 4;
   if (need > tiff_len)
     return false;
+  if (!budget.enter(ifd_off, (uint32_t)need))
+    return false;
+  scan.next_ifd = exif_load32<E>(tiff + base + (uint64_t)n * 12);
+
+  uint32_t entry_budget = budget.limits.max_entries - budget.entries;
+  if (n > entry_budget) {
+    n = (uint16_t)entry_budget;
+    budget.truncated = true;
+  }
+  budget.entries += n;
 
+  out.tags.reserve(out.tags.size() + (scan.want ? scan.remaining : n));
+  bool sorted = true;
   for (uint16_t i = 0; i < n; i++) {
     const uint8_t *ent = tiff + base + (uint64_t)i * 12;
+    uint16_t tag = exif_load16<E>(ent + 0);
+    if (out.ns == ExifNamespace::Tiff) {
+      if (tag == 0x8769)
+        scan.exif_ptr = exif_load32<E>(ent + 8);
+      else if (tag == 0x8825)
+        scan.gps_ptr = exif_load32<E>(ent + 8);
+      else if (tag == 0xA005)
+        scan.interop_ptr = exif_load32<E>(ent + 8);
+    }
+
+    if (scan.want) {
+      auto it = std::lower_bound(scan.want->begin(), scan.want->end(), tag);
+      if (it == scan.want->end() || *it != tag)
+        continue;
+      uint8_t &hit = scan.found[(size_t)(it - scan.want->begin())];
+      if (!hit) {
+        hit = 1;
+        scan.remaining--;
+      }
+    }
+
     ExifTag tg;
-    tg.tag = rd16(ent + 0, e);
-    tg.type = rd16(ent + 2, e);
-    tg.count = rd32(ent + 4, e);
-    tg.value_or_offset = rd32(ent + 8, e);
-    tg.value.text =
-        format_value(tiff, tiff_len, e, ent, tg.type, tg.count, tg.tag);
-    out.tags[tg.tag] = tg;
+    tg.tag = tag;
+    tg.type = exif_load16<E>(ent + 2);
+    tg.count = exif_load32<E>(ent + 4);
+    tg.value_or_offset = exif_load32<E>(ent + 8);
+    locate_value(tiff_len, (size_t)(ent - tiff), tg);
+    // 值字节预算：互相重叠的大偏移值会让格式化成本失控
+    if (tg.data_size > budget.limits.max_value_bytes - budget.value_bytes) {
+      tg.data_offset = kExifNoData;
+      tg.data_size = 0;
+      budget.truncated = true;
+    }
+    budget.value_bytes += tg.data_size;
+    if (!out.tags.empty() && out.tags.back().tag >= tag)
+      sorted = false;
+    out.tags.push_back(tg);
+
+    if (scan.want && scan.remaining == 0 && !scan.pointers_pending())
+      break;
   }
+  if (!sorted)
+    normalize_ifd(out);
   return true;
 }
 
-static std::optional<double>
-parse_gps_rational_triplet_deg(const uint8_t *tiff, size_t tiff_len, Endian e,
-                               const ExifTag &tag) {
-  // GPSLatitude/GPSLongitude are RATIONAL[3]
-  if (tag.type != 5 || tag.count < 3)
-    return std::nullopt;
-  uint32_t unit = tiff_type_size(tag.type);
-  uint64_t bytes = (uint64_t)unit * tag.count;
-  uint32_t off = tag.value_or_offset;
-  if (bytes <= 4) {
-    // inline not expected for RATIONAL[3]
-    return std::nullopt;
+// IFD 图遍历：IFD0 -> EXIF / GPS 子 IFD、EXIF -> Interop、IFD0 -> IFD1（next 链接）。
+// 每个 IFD 只访问一次，受 ExifLimits 限制
+template <Endian E>
+static bool walk_tiff(ExifResult &res, const ExifTagFilter *filter,
+                      const ExifLimits &limits) {
+  const uint8_t *tiff = res.tiff.data();
+  size_t tiff_len = res.tiff.size();
+  uint16_t magic = exif_load16<E>(tiff + 2);
+  if (magic != 0x2A)
+    return false;
+
+  uint32_t ifd0_off = exif_load32<E>(tiff + 4);
+  if (ifd0_off >= tiff_len)
+    return false;
+
+  const bool filtered = filter && !filter->empty();
+  IfdBudget budget(limits);
+  IfdScan main_scan;
+  size_t gps_remaining = 0;
+  size_t interop_remaining = 0;
+  if (filtered) {
+    main_scan.want = &filter->main_tags();
+    main_scan.remaining = filter->main_tags().size();
+    main_scan.found.assign(main_scan.remaining, 0);
+    gps_remaining = filter->gps_tags().size();
+    interop_remaining = filter->interop_tags().size();
+    main_scan.need_gps_ptr = gps_remaining > 0;
+    main_scan.need_exif_ptr = interop_remaining > 0;
+  }
+  // 过滤模式下只有仍有未找到的 tag 时才进入对应子 IFD
+  auto valid_off = [&](uint32_t off) { return off != 0 && off < tiff_len; };
+
+  if (!parse_ifd<E>(tiff, tiff_len, ifd0_off, res.ifd0, main_scan, budget))
+    return false;
+  uint32_t exif_off = main_scan.exif_ptr;
+  uint32_t gps_off = main_scan.gps_ptr;
+  uint32_t ifd1_off = main_scan.next_ifd;
+
+  if (valid_off(exif_off) &&
+      (!filtered || main_scan.remaining > 0 || interop_remaining > 0)) {
+    main_scan.need_gps_ptr = main_scan.need_exif_ptr = false;
+    main_scan.need_interop_ptr = interop_remaining > 0;
+    parse_ifd<E>(tiff, tiff_len, exif_off, res.exif_ifd, main_scan, budget);
+  }
+  if (valid_off(gps_off) && (!filtered || gps_remaining > 0)) {
+    IfdScan gps_scan;
+    res.gps_ifd.ns = ExifNamespace::Gps;
+    if (filtered) {
+      gps_scan.want = &filter->gps_tags();
+      gps_scan.remaining = gps_remaining;
+      gps_scan.found.assign(gps_remaining, 0);
+    }
+    parse_ifd<E>(tiff, tiff_len, gps_off, res.gps_ifd, gps_scan, budget);
   }
-  if ((uint64_t)off + 24 > tiff_len)
+  if (valid_off(main_scan.interop_ptr) &&
+      (!filtered || interop_remaining > 0)) {
+    IfdScan interop_scan;
+    res.interop_ifd.ns = ExifNamespace::Interop;
+    if (filtered) {
+      interop_scan.want = &filter->interop_tags();
+      interop_scan.remaining = interop_remaining;
+      interop_scan.found.assign(interop_remaining, 0);
+    }
+    parse_ifd<E>(tiff, tiff_len, main_scan.interop_ptr, res.interop_ifd,
+                 interop_scan, budget);
+  }
+  // IFD1（缩略图）与 IFD0 共用 TIFF 编号空间；IFD1 之后的链接不再跟随
+  if (valid_off(ifd1_off) && (!filtered || main_scan.remaining > 0)) {
+    main_scan.need_interop_ptr = false;
+    parse_ifd<E>(tiff, tiff_len, ifd1_off, res.ifd1, main_scan, budget);
+  }
+
+  res.truncated = budget.truncated;
+  return true;
+}
+
+static std::optional<double> parse_gps_rational_triplet_deg(const ExifValueView &v) {
+  // GPSLatitude/GPSLongitude are RATIONAL[3]
+  if (!v.valid() || v.type() != 5 || v.count() < 3)
     return std::nullopt;
-  const uint8_t *p = tiff + off;
-  auto rat = [&](int idx) -> double {
-    uint32_t num = rd32(p + idx * 8 + 0, e);
-    uint32_t den = rd32(p + idx * 8 + 4, e);
-    if (den == 0)
-      return 0.0;
-    return (double)num / (double)den;
-  };
-  double d = rat(0), m = rat(1), s = rat(2);
-  return d + (m / 60.0) + (s / 3600.0);
+  return v.visit([](const auto &t) {
+    auto rat = [&](int idx) -> double {
+      ExifRational r = t.rational(idx);
+      if (r.den == 0)
+        return 0.0;
+      return (double)r.num / (double)r.den;
+    };
+    double d = rat(0), m = rat(1), s = rat(2);
+    return d + (m / 60.0) + (s / 3600.0);
+  });
 }
 
+static const uint16_t kGpsCoordTags[] = {0x0001, 0x0002, 0x0003, 0x0004};
+
 std::optional<ExifResult>
-parse_exif_from_app1_payload(const std::vector<uint8_t> &payload) {
+parse_exif_from_app1_payload(ByteSpan payload, const ExifTagFilter *filter,
+                             const ExifLimits &limits) {
   if (payload.size() < 6 + 8)
     return std::nullopt;
   if (std::memcmp(payload.data(), "Exif\0\0", 6) != 0)
@@ -640,33 +1002,16 @@ parse_exif_from_app1_payload(const std::vector<uint8_t> &payload) {
   else
     return std::nullopt;
 
-  uint16_t magic = rd16(tiff + 2, e);
-  if (magic != 0x2A)
-    return std::nullopt;
-
-  uint32_t ifd0_off = rd32(tiff + 4, e);
-  if (ifd0_off >= tiff_len)
-    return std::nullopt;
-
   ExifResult res;
   res.endian = e;
-
-  if (!parse_ifd(tiff, tiff_len, e, ifd0_off, res.ifd0))
+  res.tiff = ByteSpan(tiff, tiff_len);
+  // 字节序只判断一次，之后整个 IFD 遍历都使用编译期确定的读取
+  bool ok = e == Endian::Little
+                ? walk_tiff<Endian::Little>(res, filter, limits)
+                : walk_tiff<Endian::Big>(res, filter, limits);
+  if (!ok)
     return std::nullopt;
-
-  // pointer tags: 0x8769 ExifIFDPointer, 0x8825 GPSInfoIFDPointer
-  auto it_exif_ptr = res.ifd0.tags.find(0x8769);
-  if (it_exif_ptr != res.ifd0.tags.end()) {
-    uint32_t exif_off = it_exif_ptr->second.value_or_offset;
-    if (exif_off < tiff_len)
-      parse_ifd(tiff, tiff_len, e, exif_off, res.exif_ifd);
-  }
-  auto it_gps_ptr = res.ifd0.tags.find(0x8825);
-  if (it_gps_ptr != res.ifd0.tags.end()) {
-    uint32_t gps_off = it_gps_ptr->second.value_or_offset;
-    if (gps_off < tiff_len)
-      parse_ifd(tiff, tiff_len, e, gps_off, res.gps_ifd);
-  }
+  const bool filtered = filter && !filter->empty();
 
   // GPS decode to decimal degrees if possible
   // GPS tags:
@@ -674,17 +1019,22 @@ parse_exif_from_app1_payload(const std::vector<uint8_t> &payload) {
   // 0x0002 GPSLatitude (RATIONAL[3])
   // 0x0003 GPSLongitudeRef ("E"/"W")
   // 0x0004 GPSLongitude (RATIONAL[3])
-  if (!res.gps_ifd.tags.empty()) {
-    auto lat_ref_it = res.gps_ifd.tags.find(0x0001);
-    auto lat_it = res.gps_ifd.tags.find(0x0002);
-    auto lon_ref_it = res.gps_ifd.tags.find(0x0003);
-    auto lon_it = res.gps_ifd.tags.find(0x0004);
-
-    if (lat_it != res.gps_ifd.tags.end() && lon_it != res.gps_ifd.tags.end()) {
-      auto lat =
-          parse_gps_rational_triplet_deg(tiff, tiff_len, e, lat_it->second);
-      auto lon =
-          parse_gps_rational_triplet_deg(tiff, tiff_len, e, lon_it->second);
+  if (!res.gps_ifd.empty()) {
+    const ExifTag *lat_ref_tag = res.gps_ifd.find(0x0001);
+    const ExifTag *lat_tag = res.gps_ifd.find(0x0002);
+    const ExifTag *lon_ref_tag = res.gps_ifd.find(0x0003);
+    const ExifTag *lon_tag = res.gps_ifd.find(0x0004);
+
+    // 过滤时只有四个坐标 tag 都被请求才计算，避免缺少 Ref 时误报无效
+    bool coords_wanted =
+        !filtered || (filter->gps_tags().size() >= 4 &&
+                      std::includes(filter->gps_tags().begin(),
+                                    filter->gps_tags().end(),
+                                    std::begin(kGpsCoordTags),
+                                    std::end(kGpsCoordTags)));
+    if (coords_wanted && lat_tag && lon_tag) {
+      auto lat = parse_gps_rational_triplet_deg(exif_value(res, *lat_tag));
+      auto lon = parse_gps_rational_triplet_deg(exif_value(res, *lon_tag));
 
       // 检查 GPS 数据是否有效
       bool has_valid_gps = false;
@@ -692,19 +1042,26 @@ parse_exif_from_app1_payload(const std::vector<uint8_t> &payload) {
         double latv = *lat;
         double lonv = *lon;
 
-        // 检查是否有有效的参考方向
-        bool has_lat_ref = (lat_ref_it != res.gps_ifd.tags.end() &&
-                            !lat_ref_it->second.value.text.empty());
-        bool has_lon_ref = (lon_ref_it != res.gps_ifd.tags.end() &&
-                            !lon_ref_it->second.value.text.empty());
+        // 检查是否有有效的参考方向（空 ASCII 也视为存在，与输出的 "Unknown" 一致）
+        ExifValueView lat_ref, lon_ref;
+        if (lat_ref_tag)
+          lat_ref = exif_value(res, *lat_ref_tag);
+        if (lon_ref_tag)
+          lon_ref = exif_value(res, *lon_ref_tag);
+        bool has_lat_ref = lat_ref.valid();
+        bool has_lon_ref = lon_ref.valid();
+        auto ref_is = [](const ExifValueView &ref, char c) {
+          std::string_view a = ref.type() == 2 ? ref.ascii() : std::string_view();
+          return !a.empty() && a[0] == c;
+        };
 
         // 检查坐标是否非零（全零通常表示没有 GPS 数据）
         bool is_nonzero = (std::abs(latv) > 0.0001 || std::abs(lonv) > 0.0001);
 
         if (has_lat_ref && has_lon_ref && is_nonzero) {
-          if (lat_ref_it->second.value.text[0] == 'S')
+          if (ref_is(lat_ref, 'S'))
             latv = -latv;
-          if (lon_ref_it->second.value.text[0] == 'W')
+          if (ref_is(lon_ref, 'W'))
             lonv = -lonv;
 
           res.latitude = GpsCoord{latv, true};
@@ -724,253 +1081,89 @@ parse_exif_from_app1_payload(const std::vector<uint8_t> &payload) {
   return res;
 }
 
-std::string exif_tag_name(uint16_t tag) {
-  switch (tag) {
-  // IFD0 常用标签
-  case 0x010E:
-    return "ImageDescription";
-  case 0x010F:
-    return "Make";
-  case 0x0110:
-    return "Model";
-  case 0x0112:
-    return "Orientation";
-  case 0x011A:
-    return "XResolution";
-  case 0x011B:
-    return "YResolution";
-  case 0x0128:
-    return "ResolutionUnit";
-  case 0x0131:
-    return "Software";
-  case 0x0132:
-    return "DateTime";
-  case 0x013B:
-    return "Artist";
-  case 0x013E:
-    return "WhitePoint";
-  case 0x013F:
-    return "PrimaryChromaticities";
-  case 0x0211:
-    return "YCbCrCoefficients";
-  case 0x0212:
-    return "YCbCrSubSampling";
-  case 0x0213:
-    return "YCbCrPositioning";
-  case 0x0214:
-    return "ReferenceBlackWhite";
-  case 0x8298:
-    return "Copyright";
-  case 0x8769:
-    return "ExifIFDPointer";
-  case 0x8825:
-    return "GPSInfoIFDPointer";
-
-  // EXIF IFD 常用标签
-  case 0x829A:
-    return "ExposureTime";
-  case 0x829D:
-    return "FNumber";
-  case 0x8822:
-    return "ExposureProgram";
-  case 0x8824:
-    return "SpectralSensitivity";
-  case 0x8827:
-    return "ISO";
-  case 0x8828:
-    return "OECF";
-  case 0x8830:
-    return "SensitivityType";
-  case 0x8832:
-    return "RecommendedExposureIndex";
-  case 0x9000:
-    return "ExifVersion";
-  case 0x9003:
-    return "DateTimeOriginal";
-  case 0x9004:
-    return "DateTimeDigitized";
-  case 0x9010:
-    return "OffsetTime";
-  case 0x9011:
-    return "OffsetTimeOriginal";
-  case 0x9012:
-    return "OffsetTimeDigitized";
-  case 0x9101:
-    return "ComponentsConfiguration";
-  case 0x9102:
-    return "CompressedBitsPerPixel";
-  case 0x9201:
-    return "ShutterSpeedValue";
-  case 0x9202:
-    return "ApertureValue";
-  case 0x9203:
-    return "BrightnessValue";
-  case 0x9204:
-    return "ExposureBiasValue";
-  case 0x9205:
-    return "MaxApertureValue";
-  case 0x9206:
-    return "SubjectDistance";
-  case 0x9207:
-    return "MeteringMode";
-  case 0x9208:
-    return "LightSource";
-  case 0x9209:
-    return "Flash";
-  case 0x920A:
-    return "FocalLength";
-  case 0x9214:
-    return "SubjectArea";
-  case 0x927C:
-    return "MakerNote";
-  case 0x9286:
-    return "UserComment";
-  case 0x9290:
-    return "SubSecTime";
-  case 0x9291:
-    return "SubSecTimeOriginal";
-  case 0x9292:
-    return "SubSecTimeDigitized";
-  case 0xA000:
-    return "FlashpixVersion";
-  case 0xA001:
-    return "ColorSpace";
-  case 0xA002:
-    return "PixelXDimension";
-  case 0xA003:
-    return "PixelYDimension";
-  case 0xA004:
-    return "RelatedSoundFile";
-  case 0xA005:
-    return "InteroperabilityIFDPointer";
-  case 0xA20B:
-    return "FlashEnergy";
-  case 0xA20C:
-    return "SpatialFrequencyResponse";
-  case 0xA20E:
-    return "FocalPlaneXResolution";
-  case 0xA20F:
-    return "FocalPlaneYResolution";
-  case 0xA210:
-    return "FocalPlaneResolutionUnit";
-  case 0xA214:
-    return "SubjectLocation";
-  case 0xA215:
-    return "ExposureIndex";
-  case 0xA217:
-    return "SensingMethod";
-  case 0xA300:
-    return "FileSource";
-  case 0xA301:
-    return "SceneType";
-  case 0xA302:
-    return "CFAPattern";
-  case 0xA401:
-    return "CustomRendered";
-  case 0xA402:
-    return "ExposureMode";
-  case 0xA403:
-    return "WhiteBalance";
-  case 0xA404:
-    return "DigitalZoomRatio";
-  case 0xA405:
-    return "FocalLengthIn35mmFilm";
-  case 0xA406:
-    return "SceneCaptureType";
-  case 0xA407:
-    return "GainControl";
-  case 0xA408:
-    return "Contrast";
-  case 0xA409:
-    return "Saturation";
-  case 0xA40A:
-    return "Sharpness";
-  case 0xA40B:
-    return "DeviceSettingDescription";
-  case 0xA40C:
-    return "SubjectDistanceRange";
-  case 0xA420:
-    return "ImageUniqueID";
-  case 0xA430:
-    return "CameraOwnerName";
-  case 0xA431:
-    return "BodySerialNumber";
-  case 0xA432:
-    return "LensSpecification";
-  case 0xA433:
-    return "LensMake";
-  case 0xA434:
-    return "LensModel";
-  case 0xA435:
-    return "LensSerialNumber";
-
-  // GPS IFD 常用标签
-  case 0x0000:
-    return "GPSVersionID";
-  case 0x0001:
-    return "GPSLatitudeRef";
-  case 0x0002:
-    return "GPSLatitude";
-  case 0x0003:
-    return "GPSLongitudeRef";
-  case 0x0004:
-    return "GPSLongitude";
-  case 0x0005:
-    return "GPSAltitudeRef";
-  case 0x0006:
-    return "GPSAltitude";
-  case 0x0007:
-    return "GPSTimeStamp";
-  case 0x0008:
-    return "GPSSatellites";
-  case 0x0009:
-    return "GPSStatus";
-  case 0x000A:
-    return "GPSMeasureMode";
-  case 0x000B:
-    return "GPSDOP";
-  case 0x000C:
-    return "GPSSpeedRef";
-  case 0x000D:
-    return "GPSSpeed";
-  case 0x000E:
-    return "GPSTrackRef";
-  case 0x000F:
-    return "GPSTrack";
-  case 0x0010:
-    return "GPSImgDirectionRef";
-  case 0x0011:
-    return "GPSImgDirection";
-  case 0x0012:
-    return "GPSMapDatum";
-  case 0x0013:
-    return "GPSDestLatitudeRef";
-  case 0x0014:
-    return "GPSDestLatitude";
-  case 0x0015:
-    return "GPSDestLongitudeRef";
-  case 0x0016:
-    return "GPSDestLongitude";
-  case 0x0017:
-    return "GPSDestBearingRef";
-  case 0x0018:
-    return "GPSDestBearing";
-  case 0x0019:
-    return "GPSDestDistanceRef";
-  case 0x001A:
-    return "GPSDestDistance";
-  case 0x001B:
-    return "GPSProcessingMethod";
-  case 0x001C:
-    return "GPSAreaInformation";
-  case 0x001D:
-    return "GPSDateStamp";
-  case 0x001E:
-    return "GPSDifferential";
-  case 0x001F:
-    return "GPSHPositioningError";
+static void insert_sorted(std::vector<uint16_t> &v, uint16_t tag) {
+  auto it = std::lower_bound(v.begin(), v.end(), tag);
+  if (it == v.end() || *it != tag)
+    v.insert(it, tag);
+}
 
-  default:
-    return "";
+bool ExifTagFilter::add(std::string_view pattern) {
+  if (pattern.empty())
+    return false;
+  // 编号形式：GPS 与 Interop 的编号和 TIFF/EXIF 重叠，需要用 "gps:" / "interop:"
+  // 前缀指明；不带前缀的编号属于 IFD0/EXIF/IFD1
+  std::vector<uint16_t> *ids = &main_;
+  std::string_view num = pattern;
+  if (num.rfind("gps:", 0) == 0) {
+    ids = &gps_;
+    num.remove_prefix(4);
+  } else if (num.rfind("interop:", 0) == 0) {
+    ids = &interop_;
+    num.remove_prefix(8);
   }
+  if (num.size() > 2 && num[0] == '0' && (num[1] == 'x' || num[1] == 'X')) {
+    std::string hex(num.substr(2));
+    char *end = nullptr;
+    unsigned long v = std::strtoul(hex.c_str(), &end, 16);
+    if (*end != '\0' || v > 0xFFFF)
+      return false;
+    insert_sorted(*ids, (uint16_t)v);
+    return true;
+  }
+  if (ids != &main_)
+    return false;
+
+  std::vector<const ExifTagInfo *> hits;
+  if (pattern.back() == '*') {
+    exif_tags_with_prefix(pattern.substr(0, pattern.size() - 1), hits);
+  } else if (const ExifTagInfo *info = exif_tag_by_name(pattern)) {
+    hits.push_back(info);
+  }
+  for (const ExifTagInfo *info : hits) {
+    if (info->ns == ExifNamespace::Gps)
+      insert_sorted(gps_, info->id);
+    else if (info->ns == ExifNamespace::Interop)
+      insert_sorted(interop_, info->id);
+    else
+      insert_sorted(main_, info->id);
+  }
+  return !hits.empty();
+}
+
+void exif_retain(ExifResult &exif) {
+  if (exif.tiff_owner || exif.tiff.empty())
+    return;
+  auto owned = std::make_shared<const std::vector<uint8_t>>(exif.tiff.begin(),
+                                                            exif.tiff.end());
+  exif.tiff = ByteSpan(*owned);
+  exif.tiff_owner = std::move(owned);
+}
+
+std::string_view ExifValueView::ascii() const {
+  const char *p = (const char *)data_.data();
+  size_t n = 0;
+  while (n < data_.size() && p[n] != '\0')
+    n++;
+  return std::string_view(p, n);
+}
+
+ExifValueView exif_value(const ExifResult &exif, const ExifTag &tag) {
+  if (tag.data_offset == kExifNoData ||
+      (uint64_t)tag.data_offset + tag.data_size > exif.tiff.size())
+    return ExifValueView();
+  return ExifValueView(ByteSpan(exif.tiff.data() + tag.data_offset, tag.data_size),
+                       exif.endian, tag.type, tag.count);
+}
+
+void format_exif_value(std::string &out, const ExifResult &exif,
+                       const ExifIfd &ifd, const ExifTag &tag) {
+  TextWriter w(out);
+  format_value(w, exif_value(exif, tag), tag.tag, ifd.ns);
+}
+
+std::string format_exif_value(const ExifResult &exif, const ExifIfd &ifd,
+                              const ExifTag &tag) {
+  std::string out;
+  format_exif_value(out, exif, ifd, tag);
+  return out;
 }
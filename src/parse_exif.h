@@ -1,10 +1,216 @@
 #pragma once
 #include "jpeg_types.h"
+#include "text_writer.h"
+#include <cstring>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
+// 只提取指定的 tag：按名称 ("Make")、名称前缀 ("GPS*") 或十六进制 tag 号
+// ("0x010F"；GPS 与 Interop 编号加前缀，如 "gps:0x0002"、"interop:0x0001")
+// 添加。不需要的子 IFD 不会被遍历，所有 tag 找到后立即停止
+class ExifTagFilter {
+public:
+  // 名称未知或没有匹配的 tag 时返回 false
+  bool add(std::string_view pattern);
+  bool empty() const {
+    return main_.empty() && gps_.empty() && interop_.empty();
+  }
+
+  // 各 tag 编号空间分开保存（均已排序去重）
+  const std::vector<uint16_t> &main_tags() const { return main_; }
+  const std::vector<uint16_t> &gps_tags() const { return gps_; }
+  const std::vector<uint16_t> &interop_tags() const { return interop_; }
+
+private:
+  std::vector<uint16_t> main_;
+  std::vector<uint16_t> gps_;
+  std::vector<uint16_t> interop_;
+};
+
+// IFD 遍历预算，防止恶意文件（循环/重叠偏移、超大条目数）让解析失控。
+// 超出时停止遍历并设置 ExifResult::truncated
+struct ExifLimits {
+  uint32_t max_ifds = 16;             // 最多访问的 IFD 数
+  uint32_t max_entries = 4096;        // 所有 IFD 合计的条目数
+  uint64_t max_value_bytes = 1 << 20; // 所有条目值数据合计字节数
+};
+
+// 返回的 ExifResult 引用 payload 中的 TIFF 数据（零拷贝）；
+// payload 失效前如需保留结果，调用 exif_retain()。
+// filter 为空或 nullptr 时提取全部 tag
 std::optional<ExifResult>
-parse_exif_from_app1_payload(const std::vector<uint8_t> &payload);
+parse_exif_from_app1_payload(ByteSpan payload,
+                             const ExifTagFilter *filter = nullptr,
+                             const ExifLimits &limits = ExifLimits());
+
+// 把 TIFF 数据拷贝为结果自身持有，之后与 payload 生命周期无关
+void exif_retain(ExifResult &exif);
+
+struct ExifRational {
+  uint32_t num = 0;
+  uint32_t den = 0;
+};
+struct ExifSRational {
+  int32_t num = 0;
+  int32_t den = 0;
+};
+
+// 字节序在编译期确定的读取；逐字节组合会被编译器合并为单次加载（必要时加 bswap）
+template <Endian E> inline uint16_t exif_load16(const uint8_t *p) {
+  if constexpr (E == Endian::Little)
+    return (uint16_t)(p[0] | (p[1] << 8));
+  else
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+template <Endian E> inline uint32_t exif_load32(const uint8_t *p) {
+  if constexpr (E == Endian::Little)
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+  else
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// 字节序在编译期确定的值读取，由 ExifValueView::visit() 一次分派得到；
+// 数组循环在其上读取，每个元素不再判断字节序。越界时返回 0
+template <Endian E> class ExifTypedValues {
+public:
+  explicit ExifTypedValues(ByteSpan data) : data_(data) {}
+
+  ByteSpan bytes() const { return data_; }
+  uint16_t u16(size_t i = 0) const {
+    return in_range(i, 2) ? exif_load16<E>(data_.data() + i * 2) : 0;
+  }
+  uint32_t u32(size_t i = 0) const {
+    return in_range(i, 4) ? exif_load32<E>(data_.data() + i * 4) : 0;
+  }
+  int32_t s32(size_t i = 0) const { return (int32_t)u32(i); }
+  int8_t s8(size_t i = 0) const {
+    return in_range(i, 1) ? (int8_t)data_[i] : 0;
+  }
+  int16_t s16(size_t i = 0) const { return (int16_t)u16(i); }
+  // FLOAT/DOUBLE 为 IEEE 754，字节序同 TIFF 头
+  float f32(size_t i = 0) const {
+    uint32_t b = u32(i);
+    float f;
+    std::memcpy(&f, &b, sizeof f);
+    return f;
+  }
+  double f64(size_t i = 0) const {
+    if (!in_range(i, 8))
+      return 0.0;
+    uint64_t first = exif_load32<E>(data_.data() + i * 8);
+    uint64_t second = exif_load32<E>(data_.data() + i * 8 + 4);
+    uint64_t b = E == Endian::Little ? (second << 32) | first
+                                     : (first << 32) | second;
+    double d;
+    std::memcpy(&d, &b, sizeof d);
+    return d;
+  }
+  ExifRational rational(size_t i = 0) const {
+    return {u32(i * 2), u32(i * 2 + 1)};
+  }
+  ExifSRational srational(size_t i = 0) const {
+    return {s32(i * 2), s32(i * 2 + 1)};
+  }
+
+private:
+  bool in_range(size_t i, size_t unit) const {
+    return (i + 1) * unit <= data_.size();
+  }
+
+  ByteSpan data_;
+};
+
+// 单个 tag 值的类型化只读视图，按需解码，不分配内存。
+// 单次读取的访问器各自分派一次字节序；读取多个元素时用 visit() 只分派一次
+class ExifValueView {
+public:
+  ExifValueView() = default;
+  ExifValueView(ByteSpan data, Endian e, uint16_t type, uint32_t count)
+      : data_(data), endian_(e), type_(type), count_(count) {}
+
+  Endian endian() const { return endian_; }
+  bool valid() const { return data_.data() != nullptr; }
+  uint16_t type() const { return type_; }
+  uint32_t count() const { return count_; }
+  ByteSpan bytes() const { return data_; }
+
+  // f(const ExifTypedValues<E> &)，E 为该值的字节序
+  template <class F> decltype(auto) visit(F &&f) const {
+    if (endian_ == Endian::Little)
+      return f(ExifTypedValues<Endian::Little>(data_));
+    return f(ExifTypedValues<Endian::Big>(data_));
+  }
+
+  // 越界时返回 0
+  uint16_t u16(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.u16(i); });
+  }
+  uint32_t u32(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.u32(i); });
+  }
+  int32_t s32(size_t i = 0) const { return (int32_t)u32(i); }
+  int8_t s8(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.s8(i); });
+  }
+  int16_t s16(size_t i = 0) const { return (int16_t)u16(i); }
+  float f32(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.f32(i); });
+  }
+  double f64(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.f64(i); });
+  }
+  ExifRational rational(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.rational(i); });
+  }
+  ExifSRational srational(size_t i = 0) const {
+    return visit([i](const auto &t) { return t.srational(i); });
+  }
+  // SHORT/LONG 统一按无符号整数读取
+  uint32_t uint(size_t i = 0) const {
+    return visit([&](const auto &t) -> uint32_t {
+      return type_ == 3 ? t.u16(i) : t.u32(i);
+    });
+  }
+  // ASCII：截止到第一个 '\0'
+  std::string_view ascii() const;
+
+private:
+  ByteSpan data_;
+  Endian endian_ = Endian::Little;
+  uint16_t type_ = 0;
+  uint32_t count_ = 0;
+};
+
+ExifValueView exif_value(const ExifResult &exif, const ExifTag &tag);
+
+// 输出用的可读文本（枚举映射、有理数近似值等），只在打印时调用；
+// 第一种形式追加到调用方可复用的缓冲
+void format_exif_value(std::string &out, const ExifResult &exif,
+                       const ExifIfd &ifd, const ExifTag &tag);
+std::string format_exif_value(const ExifResult &exif, const ExifIfd &ifd,
+                              const ExifTag &tag);
+
+// tag 字典条目；IFD0/IFD1/EXIF IFD 共用 TIFF 编号空间，GPS 与 Interop IFD 单独编号
+struct ExifTagInfo {
+  uint16_t id;
+  ExifNamespace ns;
+  uint16_t type; // 规范规定的 TIFF 类型，0 表示允许多种 (SHORT/LONG)
+  std::string_view name;
+  void (*mapper)(TextWriter &, uint16_t); // 写出 SHORT 枚举值的可读名称，可为空
+};
+
+// 按 (id, ns) 或名称查表（二分查找）；未知时返回 nullptr
+const ExifTagInfo *exif_tag_info(uint16_t id,
+                                 ExifNamespace ns = ExifNamespace::Tiff);
+const ExifTagInfo *exif_tag_by_name(std::string_view name);
+// 追加名称以 prefix 开头的全部条目（按名称排序），返回追加数量
+size_t exif_tags_with_prefix(std::string_view prefix,
+                             std::vector<const ExifTagInfo *> &out);
 
-// 常用tag名（可扩展）
-std::string exif_tag_name(uint16_t tag);
+// 未知 tag 返回空串
+std::string_view exif_tag_name(uint16_t tag,
+                               ExifNamespace ns = ExifNamespace::Tiff);
@@ -4,7 +4,7 @@
 #include <cstring>
 
 std::optional<IccChunk>
-parse_icc_chunk_from_app2_payload(const std::vector<uint8_t> &p) {
+parse_icc_chunk_from_app2_payload(ByteSpan p) {
   const char *sig = "ICC_PROFILE\0";
   size_t siglen = std::strlen("ICC_PROFILE") + 1;
   if (p.size() < siglen + 2)
@@ -15,7 +15,7 @@ parse_icc_chunk_from_app2_payload(const std::vector<uint8_t> &p) {
   IccChunk c;
   c.seq_no = p[siglen];
   c.seq_total = p[siglen + 1];
-  c.payload.assign(p.begin() + (siglen + 2), p.end());
+  c.payload = p.subspan(siglen + 2);
   return c;
 }
 
@@ -51,3 +51,17 @@ std::optional<IccProfile> stitch_icc_profile(std::vector<IccChunk> &chunks) {
     prof.data.insert(prof.data.end(), c.payload.begin(), c.payload.end());
   return prof;
 }
+
+bool IccCollector::add(ByteSpan app2_payload) {
+  auto chunk = parse_icc_chunk_from_app2_payload(app2_payload);
+  if (!chunk.has_value())
+    return false;
+  chunks_.push_back(*chunk);
+  return true;
+}
+
+std::optional<IccProfile> IccCollector::finish() {
+  auto prof = stitch_icc_profile(chunks_);
+  chunks_.clear();
+  return prof;
+}
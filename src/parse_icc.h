@@ -8,9 +8,21 @@
 struct IccChunk {
   uint8_t seq_no = 0;
   uint8_t seq_total = 0;
-  std::vector<uint8_t> payload; // 含ICC header后的数据片
+  ByteSpan payload; // 含ICC header后的数据片（指向段 payload，不拷贝）
 };
 
 std::optional<IccChunk>
-parse_icc_chunk_from_app2_payload(const std::vector<uint8_t> &payload);
+parse_icc_chunk_from_app2_payload(ByteSpan payload);
 std::optional<IccProfile> stitch_icc_profile(std::vector<IccChunk> &chunks);
+
+// 在一次段遍历中收集所有 ICC chunk，遍历结束后只拼接一次。
+// chunk 只保存段 payload 的视图，调用 finish() 前视图必须保持有效
+class IccCollector {
+public:
+  bool add(ByteSpan app2_payload);
+  bool empty() const { return chunks_.empty(); }
+  std::optional<IccProfile> finish();
+
+private:
+  std::vector<IccChunk> chunks_;
+};
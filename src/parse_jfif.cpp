@@ -3,7 +3,7 @@
 #include <cstring>
 
 std::optional<JfifInfo>
-parse_jfif_from_app0_payload(const std::vector<uint8_t> &p) {
+parse_jfif_from_app0_payload(ByteSpan p) {
   if (p.size() < 14)
     return std::nullopt;
   if (std::memcmp(p.data(), "JFIF\0", 5) != 0)
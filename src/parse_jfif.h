@@ -5,4 +5,4 @@
 #include <vector>
 
 std::optional<JfifInfo>
-parse_jfif_from_app0_payload(const std::vector<uint8_t> &payload);
+parse_jfif_from_app0_payload(ByteSpan payload);
@@ -13,8 +13,7 @@ bool is_sof_marker(uint16_t m) {
   return true;
 }
 
-std::optional<SofInfo> parse_sof_payload(uint16_t marker,
-                                         const std::vector<uint8_t> &p) {
+std::optional<SofInfo> parse_sof_payload(uint16_t marker, ByteSpan p) {
   if (!is_sof_marker(marker))
     return std::nullopt;
   if (p.size() < 6)
@@ -4,6 +4,5 @@
 #include <optional>
 #include <vector>
 
-std::optional<SofInfo> parse_sof_payload(uint16_t marker,
-                                         const std::vector<uint8_t> &payload);
+std::optional<SofInfo> parse_sof_payload(uint16_t marker, ByteSpan payload);
 bool is_sof_marker(uint16_t marker);
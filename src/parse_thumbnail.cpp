@@ -0,0 +1,101 @@
+// parse_thumbnail.cpp
+#include "parse_thumbnail.h"
+#include "jpeg_indexer.h"
+#include "parse_exif.h"
+#include "parse_sof.h"
+#include <cstring>
+
+// 从缩略图自身的 SOF 读取尺寸（只索引到第一个 SOS）
+static void read_jpeg_dimensions(ByteSpan jpeg, ThumbnailInfo &out) {
+  IndexOptions opt;
+  opt.stop_at_sos = true;
+  JpegIndexResult idx = build_jpeg_index(jpeg.data(), jpeg.size(), opt);
+  for (const auto &seg : idx.segments) {
+    if (!is_sof_marker(seg.marker))
+      continue;
+    auto sof = parse_sof_payload(
+        seg.marker, jpeg.subspan((size_t)seg.payload_offset, seg.payload_len));
+    if (sof.has_value()) {
+      out.width = sof->width;
+      out.height = sof->height;
+    }
+    return;
+  }
+}
+
+std::optional<ThumbnailInfo> exif_thumbnail(const ExifResult &exif,
+                                            uint64_t tiff_offset) {
+  const ExifTag *off_tag = exif.ifd1.find(0x0201); // JPEGInterchangeFormat
+  const ExifTag *len_tag = exif.ifd1.find(0x0202); // JPEGInterchangeFormatLength
+  if (!off_tag || !len_tag)
+    return std::nullopt;
+  uint32_t off = exif_value(exif, *off_tag).uint();
+  uint32_t len = exif_value(exif, *len_tag).uint();
+  if (len < 4 || (uint64_t)off + len > exif.tiff.size())
+    return std::nullopt;
+  ByteSpan jpeg = exif.tiff.subspan(off, len);
+  if (jpeg[0] != 0xFF || jpeg[1] != 0xD8)
+    return std::nullopt;
+
+  ThumbnailInfo t;
+  t.kind = ThumbnailKind::Exif;
+  t.offset = tiff_offset + off;
+  t.length = len;
+  read_jpeg_dimensions(jpeg, t);
+  return t;
+}
+
+std::optional<ThumbnailInfo> parse_jfxx_thumbnail(ByteSpan payload,
+                                                  uint64_t payload_offset) {
+  // "JFXX\0" + 扩展码 + 缩略图数据
+  if (payload.size() < 6 || std::memcmp(payload.data(), "JFXX\0", 5) != 0)
+    return std::nullopt;
+  uint8_t code = payload[5];
+  ByteSpan data = payload.subspan(6);
+
+  ThumbnailInfo t;
+  t.offset = payload_offset + 6;
+  t.length = data.size();
+  switch (code) {
+  case 0x10:
+    if (data.size() < 4 || data[0] != 0xFF || data[1] != 0xD8)
+      return std::nullopt;
+    t.kind = ThumbnailKind::JfxxJpeg;
+    read_jpeg_dimensions(data, t);
+    return t;
+  case 0x11:
+  case 0x13: {
+    if (data.size() < 2)
+      return std::nullopt;
+    t.kind = code == 0x11 ? ThumbnailKind::JfxxPalette : ThumbnailKind::JfxxRgb;
+    t.width = data[0];
+    t.height = data[1];
+    uint64_t need = 2 + (code == 0x11 ? 768 + (uint64_t)t.width * t.height
+                                      : (uint64_t)t.width * t.height * 3);
+    if (data.size() < need)
+      return std::nullopt;
+    t.length = need;
+    return t;
+  }
+  default:
+    return std::nullopt;
+  }
+}
+
+bool thumbnail_bytes(ByteSource &src, const ThumbnailInfo &thumb,
+                     std::vector<uint8_t> &storage, ByteSpan &out) {
+  ByteSpan all = src.contiguous();
+  if (all.data() != nullptr) {
+    if (thumb.offset > all.size() || thumb.length > all.size() - thumb.offset)
+      return false;
+    out = ByteSpan(all.data() + thumb.offset, (size_t)thumb.length);
+    src.count_view((size_t)thumb.length);
+    return true;
+  }
+  storage.resize((size_t)thumb.length);
+  if (src.read_at(thumb.offset, storage.data(), storage.size()) !=
+      storage.size())
+    return false;
+  out = ByteSpan(storage);
+  return true;
+}
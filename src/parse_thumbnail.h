@@ -0,0 +1,25 @@
+// parse_thumbnail.h
+#pragma once
+#include "byte_source.h"
+#include "jpeg_types.h"
+#include <optional>
+#include <vector>
+
+// EXIF IFD1 (JPEGInterchangeFormat/Length) 中的 JPEG 缩略图。
+// tiff_offset 是 TIFF 数据在源文件中的偏移（APP1 payload 偏移 + 6）
+std::optional<ThumbnailInfo> exif_thumbnail(const ExifResult &exif,
+                                            uint64_t tiff_offset);
+
+// JFXX 扩展段 (APP0 "JFXX\0") 中的缩略图；payload_offset 是段 payload 在源文件中的偏移
+std::optional<ThumbnailInfo> parse_jfxx_thumbnail(ByteSpan payload,
+                                                  uint64_t payload_offset);
+
+// 取缩略图字节：内存型数据源（映射文件/内存缓冲）返回零拷贝视图，其他数据源读入 storage
+bool thumbnail_bytes(ByteSource &src, const ThumbnailInfo &thumb,
+                     std::vector<uint8_t> &storage, ByteSpan &out);
+
+// 缩略图是否为完整的 JPEG 文件（可直接写出）
+inline bool thumbnail_is_jpeg(const ThumbnailInfo &thumb) {
+  return thumb.kind == ThumbnailKind::Exif ||
+         thumb.kind == ThumbnailKind::JfxxJpeg;
+}
@@ -1,97 +1,568 @@
 // parse_xmp.cpp
 #include "parse_xmp.h"
+#include <algorithm>
 #include <cstring>
 
-// 查找 XMP packet 的有效结束位置
-static size_t find_xmp_end(const char *data, size_t len) {
-  size_t end_pos = len;
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JPEGINFO_XMP_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(JPEGINFO_XMP_SSE2)
+// 最高的置位下标；v 不为 0
+static inline unsigned highest_bit(uint32_t v) {
+#if defined(_MSC_VER)
+  unsigned long idx = 0;
+  _BitScanReverse(&idx, v);
+  return (unsigned)idx;
+#else
+  return 31u - (unsigned)__builtin_clz(v);
+#endif
+}
+#endif
+
+// packet 尾部的 padding：空白、\0 与 0x1A
+static inline bool is_xmp_padding(unsigned char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\0' ||
+         ch == 0x1A;
+}
+
+// 从 len 向前跳过 padding，返回有效内容的结束位置；每次比较 16 字节
+static size_t trim_xmp_padding(const char *data, size_t len) {
+#if defined(JPEGINFO_XMP_SSE2)
+  const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'),
+                cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n'),
+                nul = _mm_setzero_si128(), sub = _mm_set1_epi8(0x1A);
+  while (len >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + len - 16));
+    __m128i pad = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, nul), _mm_cmpeq_epi8(v, sub)));
+    uint32_t keep = ~(uint32_t)_mm_movemask_epi8(pad) & 0xFFFF;
+    if (keep)
+      return len - 16 + highest_bit(keep) + 1;
+    len -= 16;
+  }
+#endif
+  while (len > 0 && is_xmp_padding((unsigned char)data[len - 1]))
+    len--;
+  return len;
+}
+
+// [0, end) 中最后一个 '<' 的位置，没有时返回 npos
+static constexpr size_t kNpos = (size_t)-1;
+static size_t rfind_open_angle(const char *data, size_t end) {
+#if defined(JPEGINFO_XMP_SSE2)
+  const __m128i lt = _mm_set1_epi8('<');
+  while (end >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + end - 16));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, lt));
+    if (mask)
+      return end - 16 + highest_bit(mask);
+    end -= 16;
+  }
+#endif
+  while (end > 0)
+    if (data[--end] == '<')
+      return end;
+  return kNpos;
+}
 
-  // 优先查找 <?xpacket end= 标记（最可靠）
-  const char *xpacket_end = "<?xpacket end=";
-  size_t xpacket_end_len = std::strlen(xpacket_end);
+static bool starts_with(const char *p, size_t avail, const char *lit,
+                        size_t n) {
+  return avail >= n && std::memcmp(p, lit, n) == 0;
+}
+
+// 查找 XMP packet 的有效结束位置。trailer 位于 packet 末尾，所以先向前跳过
+// padding，再从后向前逐个检查 '<'（trailer 总在 </x:xmpmeta> 之后，遇到它即可停止）：
+// - trailer 之后还有 padding 时，有效内容到 <?xpacket end=...?> 为止；
+// - trailer 紧贴 payload 末尾（padding 在 packet 内部）时，有效内容到 </x:xmpmeta>
+//   为止，packet 内的空白与 trailer 计为 padding；
+// 都没有时取去掉 padding 的长度
+static size_t find_xmp_end(const char *data, size_t len) {
+  static const char kPacketEnd[] = "<?xpacket end=";
+  static const char kMetaEnd[] = "</x:xmpmeta>";
+  const size_t packet_end_len = sizeof(kPacketEnd) - 1;
+  const size_t meta_end_len = sizeof(kMetaEnd) - 1;
 
-  for (size_t i = 0; i + xpacket_end_len < len; i++) {
-    if (std::memcmp(data + i, xpacket_end, xpacket_end_len) == 0) {
+  size_t content_end = trim_xmp_padding(data, len);
+  size_t pos = content_end;
+  while ((pos = rfind_open_angle(data, pos)) != kNpos) {
+    const char *p = data + pos;
+    size_t avail = content_end - pos;
+    if (starts_with(p, avail, kPacketEnd, packet_end_len)) {
       // 找到 <?xpacket end=，继续查找结束的 ?>
-      for (size_t j = i + xpacket_end_len; j + 1 < len; j++) {
+      for (size_t j = pos + packet_end_len; j + 1 < content_end; j++) {
         if (data[j] == '?' && data[j + 1] == '>') {
-          end_pos = j + 2; // ?> 之后的位置
+          if (j + 2 < len)
+            return j + 2;
           break;
         }
       }
-      if (end_pos < len)
-        break; // 找到了，跳出外层循环
+    } else if (starts_with(p, avail, kMetaEnd, meta_end_len)) {
+      return pos + meta_end_len;
     }
   }
+  return content_end;
+}
 
-  // 如果没找到 <?xpacket end=，查找 </x:xmpmeta>（次可靠）
-  if (end_pos == len) {
-    const char *xmpmeta_end = "</x:xmpmeta>";
-    size_t xmpmeta_end_len = std::strlen(xmpmeta_end);
+namespace {
 
-    for (size_t i = 0; i + xmpmeta_end_len <= len; i++) {
-      if (std::memcmp(data + i, xmpmeta_end, xmpmeta_end_len) == 0) {
-        end_pos = i + xmpmeta_end_len;
-        break;
-      }
-    }
+struct KnownNamespace {
+  std::string_view prefix;
+  std::string_view uri;
+};
+
+constexpr KnownNamespace kKnownNamespaces[] = {
+    {"xmp", "http://ns.adobe.com/xap/1.0/"},
+    {"xmpMM", "http://ns.adobe.com/xap/1.0/mm/"},
+    {"xmpRights", "http://ns.adobe.com/xap/1.0/rights/"},
+    {"xmpDM", "http://ns.adobe.com/xmp/1.0/DynamicMedia/"},
+    {"dc", "http://purl.org/dc/elements/1.1/"},
+    {"aux", "http://ns.adobe.com/exif/1.0/aux/"},
+    {"exif", "http://ns.adobe.com/exif/1.0/"},
+    {"exifEX", "http://cipa.jp/exif/1.0/"},
+    {"tiff", "http://ns.adobe.com/tiff/1.0/"},
+    {"photoshop", "http://ns.adobe.com/photoshop/1.0/"},
+    {"crs", "http://ns.adobe.com/camera-raw-settings/1.0/"},
+    {"lr", "http://ns.adobe.com/lightroom/1.0/"},
+    {"Iptc4xmpCore", "http://iptc.org/std/Iptc4xmpCore/1.0/xmlns/"},
+    {"GPano", "http://ns.google.com/photos/1.0/panorama/"},
+    {"rdf", "http://www.w3.org/1999/02/22-rdf-syntax-ns#"},
+    {"xml", "http://www.w3.org/XML/1998/namespace"},
+};
+
+constexpr std::string_view kRdfNs = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+
+inline bool is_xml_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// 按 UTF-8 追加码点
+void append_utf8(std::string &out, uint32_t cp) {
+  if (cp < 0x80) {
+    out += (char)cp;
+  } else if (cp < 0x800) {
+    out += (char)(0xC0 | (cp >> 6));
+    out += (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += (char)(0xE0 | (cp >> 12));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
+  } else {
+    out += (char)(0xF0 | (cp >> 18));
+    out += (char)(0x80 | ((cp >> 12) & 0x3F));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
   }
+}
 
-  // 关键修复：无论找到哪种结束标记，都要 trim 尾部的空白和 \0
-  while (end_pos > 0) {
-    unsigned char ch = (unsigned char)data[end_pos - 1];
-    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\0' ||
-        ch == 0x1A) {
-      end_pos--;
+// "#" 之后的字符引用：十进制或 x 开头的十六进制
+bool parse_char_ref(std::string_view ref, uint32_t &cp) {
+  int base = 10;
+  if (!ref.empty() && (ref[0] == 'x' || ref[0] == 'X')) {
+    base = 16;
+    ref.remove_prefix(1);
+  }
+  if (ref.empty() || ref.size() > 7)
+    return false;
+  cp = 0;
+  for (char c : ref) {
+    int d = c >= '0' && c <= '9' ? c - '0'
+            : c >= 'a' && c <= 'f' ? c - 'a' + 10
+            : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                   : base;
+    if (d >= base)
+      return false;
+    cp = cp * (uint32_t)base + (uint32_t)d;
+  }
+  return cp > 0 && cp <= 0x10FFFF && !(cp >= 0xD800 && cp <= 0xDFFF);
+}
+
+// 追加文本并解码预定义实体与字符引用；无法识别的实体原样保留
+void append_decoded(std::string &out, std::string_view s) {
+  size_t i = 0;
+  while (i < s.size()) {
+    size_t amp = s.find('&', i);
+    if (amp == std::string_view::npos) {
+      out.append(s.data() + i, s.size() - i);
+      return;
+    }
+    out.append(s.data() + i, amp - i);
+    // 实体名很短，只在附近找 ';'，避免大量孤立的 '&' 造成二次方扫描
+    size_t semi = s.substr(0, amp + 12).find(';', amp);
+    std::string_view ent = semi == std::string_view::npos
+                               ? std::string_view()
+                               : s.substr(amp + 1, semi - amp - 1);
+    bool ok = true;
+    if (ent == "amp")
+      out += '&';
+    else if (ent == "lt")
+      out += '<';
+    else if (ent == "gt")
+      out += '>';
+    else if (ent == "quot")
+      out += '"';
+    else if (ent == "apos")
+      out += '\'';
+    else if (ent.size() > 1 && ent[0] == '#') {
+      uint32_t cp = 0;
+      ok = parse_char_ref(ent.substr(1), cp);
+      if (ok)
+        append_utf8(out, cp);
     } else {
+      ok = false;
+    }
+    if (!ok) {
+      out += '&';
+      i = amp + 1;
+      continue;
+    }
+    i = semi + 1;
+  }
+}
+
+// 单遍扫描器：命名空间绑定与元素栈都是指向 packet 的视图，不拷贝名称
+class XmpScanner {
+public:
+  XmpScanner(std::string_view xml, const XmpPropertySet &props,
+             std::vector<XmpProperty> &out)
+      : xml_(xml), props_(props), out_(out) {}
+
+  void run();
+
+private:
+  enum class Role : uint8_t {
+    Other,
+    Rdf, // rdf:RDF
+    Description,
+    Property,
+    Container,
+    Item
+  };
+
+  struct Binding {
+    std::string_view prefix;
+    std::string_view uri;
+  };
+  struct Frame {
+    Role role = Role::Other;
+    size_t ns_mark = 0; // 进入元素前的绑定数
+    int prop = -1;      // 需要提取时为 out_ 中的下标
+    bool has_child = false;
+    bool has_value = false; // 已通过 rdf:resource 取得值
+  };
+  struct Attr {
+    std::string_view name;
+    std::string_view value; // 未解码
+  };
+
+  bool start_tag(size_t &pos);
+  void end_element();
+  std::string_view lookup(std::string_view prefix) const;
+  std::string_view resolve(std::string_view qname, bool attr,
+                           std::string_view &local) const;
+  int property_slot(std::string_view uri, std::string_view local);
+  void add_value(int slot, std::string_view raw);
+  bool capturing() const {
+    return !frames_.empty() && frames_.back().prop >= 0 &&
+           (frames_.back().role == Role::Property ||
+            frames_.back().role == Role::Item);
+  }
+
+  std::string_view xml_;
+  const XmpPropertySet &props_;
+  std::vector<XmpProperty> &out_;
+  std::vector<Binding> ns_;
+  std::vector<Frame> frames_;
+  std::vector<Attr> attrs_;
+  // out_ 各项的 (URI, 本地名)，用于去重
+  std::vector<std::pair<std::string_view, std::string_view>> keys_;
+  std::string text_;
+};
+
+std::string_view XmpScanner::lookup(std::string_view prefix) const {
+  for (size_t i = ns_.size(); i-- > 0;)
+    if (ns_[i].prefix == prefix)
+      return ns_[i].uri;
+  // 未声明的常用前缀（部分工具省略 xmlns）按约定的 URI 处理
+  return prefix.empty() ? std::string_view() : xmp_namespace_uri(prefix);
+}
+
+// 无前缀的元素使用默认命名空间，无前缀的属性没有命名空间
+std::string_view XmpScanner::resolve(std::string_view qname, bool attr,
+                                     std::string_view &local) const {
+  size_t colon = qname.find(':');
+  if (colon == std::string_view::npos) {
+    local = qname;
+    return attr ? std::string_view() : lookup(std::string_view());
+  }
+  local = qname.substr(colon + 1);
+  return lookup(qname.substr(0, colon));
+}
+
+int XmpScanner::property_slot(std::string_view uri, std::string_view local) {
+  if (uri.empty())
+    return -1;
+  const XmpPropertySet::Entry *e = props_.match(uri, local);
+  if (!e)
+    return -1;
+  for (const auto &k : keys_)
+    if (k.first == uri && k.second == local)
+      return -1; // 只保留第一次出现
+  keys_.emplace_back(uri, local);
+  XmpProperty p;
+  p.name.reserve(e->prefix.size() + 1 + local.size());
+  p.name.append(e->prefix).append(1, ':').append(local.data(), local.size());
+  out_.push_back(std::move(p));
+  return (int)out_.size() - 1;
+}
+
+void XmpScanner::add_value(int slot, std::string_view raw) {
+  std::string v;
+  append_decoded(v, raw);
+  out_[(size_t)slot].values.push_back(std::move(v));
+}
+
+// pos 指向 '<'；成功时移到标签之后
+bool XmpScanner::start_tag(size_t &pos) {
+  const size_t n = xml_.size();
+  size_t p = pos + 1;
+  size_t name_begin = p;
+  while (p < n && !is_xml_space(xml_[p]) && xml_[p] != '>' && xml_[p] != '/')
+    p++;
+  std::string_view qname = xml_.substr(name_begin, p - name_begin);
+  if (qname.empty())
+    return false;
+
+  attrs_.clear();
+  bool self_close = false;
+  while (true) {
+    while (p < n && is_xml_space(xml_[p]))
+      p++;
+    if (p >= n)
+      return false;
+    if (xml_[p] == '>') {
+      p++;
+      break;
+    }
+    if (xml_[p] == '/') {
+      if (p + 1 >= n || xml_[p + 1] != '>')
+        return false;
+      self_close = true;
+      p += 2;
       break;
     }
+    size_t an = p;
+    while (p < n && xml_[p] != '=' && !is_xml_space(xml_[p]) && xml_[p] != '>')
+      p++;
+    std::string_view aname = xml_.substr(an, p - an);
+    while (p < n && is_xml_space(xml_[p]))
+      p++;
+    if (p >= n || xml_[p] != '=' || aname.empty())
+      return false;
+    p++;
+    while (p < n && is_xml_space(xml_[p]))
+      p++;
+    if (p >= n || (xml_[p] != '"' && xml_[p] != '\''))
+      return false;
+    size_t close = xml_.find(xml_[p], p + 1);
+    if (close == std::string_view::npos)
+      return false;
+    attrs_.push_back({aname, xml_.substr(p + 1, close - p - 1)});
+    p = close + 1;
   }
+  pos = p;
 
-  return end_pos;
-}
-
-// 简单的 XML 标签提取器（不是完整的 XML 解析器）
-static std::string extract_xml_tag_content(const std::string &xml,
-                                           const std::string &tag) {
-  // 查找 <tag>content</tag> 或 <prefix:tag>content</prefix:tag>
-  std::string pattern1 = "<" + tag + ">";
-  std::string pattern2 = "</" + tag + ">";
-  std::string pattern3 = ":" + tag + ">";
-  std::string pattern4 = ":/" + tag + ">";
-
-  size_t start = xml.find(pattern1);
-  if (start == std::string::npos) {
-    // 尝试带命名空间的形式
-    start = xml.find(pattern3);
-    if (start == std::string::npos)
-      return "";
-    start = xml.rfind('<', start);
-    if (start == std::string::npos)
-      return "";
-    start = xml.find('>', start);
-    if (start == std::string::npos)
-      return "";
-  } else {
-    start += pattern1.length();
+  Frame f;
+  f.ns_mark = ns_.size();
+  for (const auto &a : attrs_) {
+    if (a.name == "xmlns")
+      ns_.push_back({std::string_view(), a.value});
+    else if (a.name.size() > 6 && a.name.substr(0, 6) == "xmlns:")
+      ns_.push_back({a.name.substr(6), a.value});
+  }
+
+  std::string_view local;
+  std::string_view uri = resolve(qname, false, local);
+  const bool rdf = uri == kRdfNs;
+  Frame *parent = frames_.empty() ? nullptr : &frames_.back();
+  if (parent)
+    parent->has_child = true;
+
+  if (rdf && local == "RDF") {
+    f.role = Role::Rdf;
+  } else if (rdf && local == "Description" &&
+             (!parent || parent->role == Role::Rdf)) {
+    // 只有顶层的 rdf:Description 描述资源；属性内部的是结构体值，保持 Other
+    f.role = Role::Description;
+    // 属性写法：rdf:Description 上的每个带命名空间的属性都是一个单值属性
+    for (const auto &a : attrs_) {
+      if (a.name == "xmlns" || a.name.substr(0, 6) == "xmlns:")
+        continue;
+      std::string_view alocal;
+      std::string_view auri = resolve(a.name, true, alocal);
+      if (auri == kRdfNs || auri == xmp_namespace_uri("xml"))
+        continue;
+      int slot = property_slot(auri, alocal);
+      if (slot >= 0)
+        add_value(slot, a.value);
+    }
+  } else if (parent && parent->role == Role::Description) {
+    f.role = Role::Property;
+    f.prop = property_slot(uri, local);
+    if (f.prop >= 0) {
+      for (const auto &a : attrs_) {
+        std::string_view alocal;
+        if (resolve(a.name, true, alocal) == kRdfNs && alocal == "resource") {
+          add_value(f.prop, a.value);
+          f.has_value = true;
+        }
+      }
+    }
+  } else if (parent && parent->role == Role::Property && rdf &&
+             (local == "Alt" || local == "Seq" || local == "Bag")) {
+    f.role = Role::Container;
+    f.prop = parent->prop;
+    if (f.prop >= 0)
+      out_[(size_t)f.prop].form = local == "Alt"   ? XmpValueForm::Alt
+                                  : local == "Seq" ? XmpValueForm::Seq
+                                                   : XmpValueForm::Bag;
+  } else if (parent && parent->role == Role::Container && rdf &&
+             local == "li") {
+    f.role = Role::Item;
+    f.prop = parent->prop;
   }
 
-  size_t end = xml.find(pattern2, start);
-  if (end == std::string::npos) {
-    end = xml.find(pattern4, start);
-    if (end == std::string::npos)
-      return "";
-    end = xml.rfind('<', end);
+  text_.clear();
+  frames_.push_back(f);
+  if (self_close)
+    end_element();
+  return true;
+}
+
+void XmpScanner::end_element() {
+  if (frames_.empty())
+    return;
+  Frame f = frames_.back();
+  frames_.pop_back();
+  ns_.resize(f.ns_mark);
+  // 只有文本内容的属性/数组项；含子元素（结构体等）的不提取
+  if (f.prop >= 0 && !f.has_child && !f.has_value &&
+      (f.role == Role::Property || f.role == Role::Item))
+    out_[(size_t)f.prop].values.push_back(text_);
+  text_.clear();
+}
+
+void XmpScanner::run() {
+  const size_t n = xml_.size();
+  size_t i = 0;
+  while (i < n) {
+    const char *lt = (const char *)std::memchr(xml_.data() + i, '<', n - i);
+    size_t end = lt ? (size_t)(lt - xml_.data()) : n;
+    if (capturing())
+      append_decoded(text_, xml_.substr(i, end - i));
+    if (!lt)
+      break;
+    i = end;
+    std::string_view rest = xml_.substr(i);
+    size_t skip = std::string_view::npos;
+    if (rest.substr(0, 4) == "<!--") {
+      size_t e = rest.find("-->", 4);
+      skip = e == std::string_view::npos ? e : e + 3;
+    } else if (rest.substr(0, 9) == "<![CDATA[") {
+      size_t e = rest.find("]]>", 9);
+      if (e != std::string_view::npos && capturing())
+        text_.append(rest.data() + 9, e - 9);
+      skip = e == std::string_view::npos ? e : e + 3;
+    } else if (rest.substr(0, 2) == "<?") {
+      size_t e = rest.find("?>", 2);
+      skip = e == std::string_view::npos ? e : e + 2;
+    } else if (rest.substr(0, 2) == "<!") {
+      size_t e = rest.find('>', 2);
+      skip = e == std::string_view::npos ? e : e + 1;
+    } else if (rest.substr(0, 2) == "</") {
+      size_t e = rest.find('>', 2);
+      if (e != std::string_view::npos)
+        end_element();
+      skip = e == std::string_view::npos ? e : e + 1;
+    } else {
+      if (!start_tag(i))
+        break;
+      continue;
+    }
+    if (skip == std::string_view::npos)
+      break;
+    i += skip;
   }
+  // 需要的属性没有取到值（如结构体）时不输出
+  out_.erase(std::remove_if(out_.begin(), out_.end(),
+                            [](const XmpProperty &p) { return p.values.empty(); }),
+             out_.end());
+}
+
+} // namespace
+
+std::string_view xmp_namespace_uri(std::string_view prefix) {
+  for (const auto &k : kKnownNamespaces)
+    if (k.prefix == prefix)
+      return k.uri;
+  return std::string_view();
+}
 
-  if (end <= start)
-    return "";
-  return xml.substr(start, end - start);
+bool XmpPropertySet::add(std::string_view qualified) {
+  size_t colon = qualified.find(':');
+  if (colon == std::string_view::npos || colon + 1 == qualified.size())
+    return false;
+  std::string_view prefix = qualified.substr(0, colon);
+  std::string_view name = qualified.substr(colon + 1);
+  std::string_view uri = xmp_namespace_uri(prefix);
+  if (uri.empty())
+    return false;
+  add(uri, prefix, name == "*" ? std::string_view() : name);
+  return true;
+}
+
+void XmpPropertySet::add(std::string_view uri, std::string_view prefix,
+                         std::string_view name) {
+  entries_.push_back({std::string(uri), std::string(prefix), std::string(name)});
+}
+
+const XmpPropertySet::Entry *
+XmpPropertySet::match(std::string_view uri, std::string_view local) const {
+  for (const auto &e : entries_)
+    if (e.uri == uri && (e.name.empty() || e.name == local))
+      return &e;
+  return nullptr;
+}
+
+const XmpPropertySet &XmpPropertySet::common() {
+  static const XmpPropertySet s = [] {
+    XmpPropertySet set;
+    for (const char *q : {"xmp:Rating", "xmp:CreateDate", "xmp:ModifyDate",
+                          "aux:Lens", "exifEX:LensModel", "dc:title",
+                          "dc:creator", "dc:subject"})
+      set.add(q);
+    return set;
+  }();
+  return s;
+}
+
+void extract_xmp_properties(std::string_view xml, const XmpPropertySet &props,
+                            std::vector<XmpProperty> &out) {
+  if (props.empty())
+    return;
+  XmpScanner(xml, props, out).run();
 }
 
 std::optional<XmpInfo>
-parse_xmp_from_app1_payload(const std::vector<uint8_t> &p, bool full,
-                            size_t max_preview) {
+parse_xmp_from_app1_payload(ByteSpan p, bool full, size_t max_preview,
+                            const XmpPropertySet &props) {
   const char *sig = "http://ns.adobe.com/xap/1.0/\0";
   size_t siglen = std::strlen("http://ns.adobe.com/xap/1.0/") + 1;
   if (p.size() < siglen)
@@ -127,29 +598,8 @@ parse_xmp_from_app1_payload(const std::vector<uint8_t> &p, bool full,
       ch = ' ';
   }
 
-  // 提取常见字段（轻量级提取，不是完整 XML 解析）
-  std::string rating = extract_xml_tag_content(x.xml, "Rating");
-  std::string create_date = extract_xml_tag_content(x.xml, "CreateDate");
-  std::string modify_date = extract_xml_tag_content(x.xml, "ModifyDate");
-  std::string lens = extract_xml_tag_content(x.xml, "Lens");
-  std::string lens_model = extract_xml_tag_content(x.xml, "LensModel");
-
-  // 将提取的字段添加到 XMP 信息中
-  if (!rating.empty() || !create_date.empty() || !lens.empty()) {
-    std::string summary = "\n[Extracted Fields]\n";
-    if (!rating.empty())
-      summary += "  Rating: " + rating + "\n";
-    if (!create_date.empty())
-      summary += "  CreateDate: " + create_date + "\n";
-    if (!modify_date.empty())
-      summary += "  ModifyDate: " + modify_date + "\n";
-    if (!lens.empty())
-      summary += "  Lens: " + lens + "\n";
-    if (!lens_model.empty())
-      summary += "  LensModel: " + lens_model + "\n";
-    summary += "\n[Full XML]\n";
-    x.xml = summary + x.xml;
-  }
-
+  // 一次遍历完整 packet 提取属性（截断预览不影响）
+  extract_xmp_properties(std::string_view(xml_start, effective_end), props,
+                         x.properties);
   return x;
 }
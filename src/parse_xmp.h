@@ -2,8 +2,46 @@
 #pragma once
 #include "jpeg_types.h"
 #include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
+// 需要提取的 XMP 属性，按命名空间 URI + 本地名匹配（与文件中使用的前缀无关）
+class XmpPropertySet {
+public:
+  struct Entry {
+    std::string uri;
+    std::string prefix; // 输出名称使用的前缀
+    std::string name;   // 为空表示该命名空间的全部属性
+  };
+
+  // "xmp:Rating"、"dc:subject" 或 "photoshop:*"；前缀须为常用前缀
+  // （xmp、dc、aux、exif、exifEX、tiff、photoshop、xmpMM 等），未知时返回 false
+  bool add(std::string_view qualified);
+  // 自定义命名空间
+  void add(std::string_view uri, std::string_view prefix, std::string_view name);
+  bool empty() const { return entries_.empty(); }
+  const std::vector<Entry> &entries() const { return entries_; }
+  const Entry *match(std::string_view uri, std::string_view local) const;
+
+  // 默认提取：xmp:Rating/CreateDate/ModifyDate、aux:Lens、exifEX:LensModel、
+  // dc:title/creator/subject
+  static const XmpPropertySet &common();
+
+private:
+  std::vector<Entry> entries_;
+};
+
+// 常用前缀对应的命名空间 URI，未知时返回空
+std::string_view xmp_namespace_uri(std::string_view prefix);
+
+// 单遍 SAX 式扫描：解析命名空间声明，提取 props 中的属性。支持元素写法
+// (<xmp:Rating>5</xmp:Rating>)、rdf:Description 上的属性写法 (xmp:Rating="5")、
+// rdf:resource 与 rdf:Alt/Seq/Bag 数组。不是完整的 XML 解析器，遇到格式错误时停止
+void extract_xmp_properties(std::string_view xml, const XmpPropertySet &props,
+                            std::vector<XmpProperty> &out);
+
+// props 为空时不提取属性；属性总是从完整 packet 中提取，与 full/max_preview 无关
 std::optional<XmpInfo>
-parse_xmp_from_app1_payload(const std::vector<uint8_t> &payload, bool full,
-                            size_t max_preview);
+parse_xmp_from_app1_payload(ByteSpan payload, bool full, size_t max_preview,
+                            const XmpPropertySet &props = XmpPropertySet::common());
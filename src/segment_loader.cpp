@@ -0,0 +1,65 @@
+// segment_loader.cpp
+#include "segment_loader.h"
+#include <algorithm>
+
+SegmentLoader::SegmentLoader(ByteSource &src, const CoalesceOptions &opt)
+    : src_(src), opt_(opt), all_(src.contiguous()) {}
+
+void SegmentLoader::want(const SegmentIndex &seg) {
+  if (all_.data() == nullptr && seg.payload_len > 0)
+    wanted_.emplace_back(seg.payload_offset,
+                         seg.payload_offset + seg.payload_len);
+}
+
+void SegmentLoader::fetch() {
+  // 索引按文件顺序产生，通常已经有序
+  std::sort(wanted_.begin(), wanted_.end());
+  for (const auto &w : wanted_) {
+    if (!ranges_.empty()) {
+      Range &last = ranges_.back();
+      uint64_t end = last.offset + last.len;
+      if (w.first <= end + opt_.max_gap &&
+          std::max(end, w.second) - last.offset <= opt_.max_range) {
+        last.len = std::max(end, w.second) - last.offset;
+        continue;
+      }
+    }
+    Range r;
+    r.offset = w.first;
+    r.len = w.second - w.first;
+    ranges_.push_back(std::move(r));
+  }
+  wanted_.clear();
+
+  for (auto &r : ranges_) {
+    r.data.resize((size_t)r.len);
+    r.data.resize(src_.read_at(r.offset, r.data.data(), r.data.size()));
+  }
+}
+
+bool SegmentLoader::payload(const SegmentIndex &seg, ByteSpan &out) const {
+  if (all_.data() != nullptr) {
+    if (seg.payload_offset > all_.size() ||
+        seg.payload_len > all_.size() - seg.payload_offset)
+      return false;
+    out = ByteSpan(all_.data() + seg.payload_offset, seg.payload_len);
+    src_.count_view(seg.payload_len);
+    return true;
+  }
+  if (seg.payload_len == 0) {
+    out = ByteSpan();
+    return true;
+  }
+  // 最后一个起点不大于 payload_offset 的区间
+  auto it = std::upper_bound(
+      ranges_.begin(), ranges_.end(), seg.payload_offset,
+      [](uint64_t off, const Range &r) { return off < r.offset; });
+  if (it == ranges_.begin())
+    return false;
+  const Range &r = *--it;
+  uint64_t rel = seg.payload_offset - r.offset;
+  if (rel > r.data.size() || seg.payload_len > r.data.size() - rel)
+    return false;
+  out = ByteSpan(r.data.data() + rel, seg.payload_len);
+  return true;
+}
@@ -0,0 +1,43 @@
+// segment_loader.h
+#pragma once
+#include "byte_source.h"
+#include "jpeg_types.h"
+#include <cstdint>
+#include <vector>
+
+// 相邻段合并成一次读取的条件
+struct CoalesceOptions {
+  uint64_t max_gap = 16 * 1024;          // 两段之间空隙不超过该值时合并（空隙一并读取）
+  uint64_t max_range = 16 * 1024 * 1024; // 合并后单次读取的上限（单段超过时单独读取）
+};
+
+// 批量加载段 payload：先用 want() 登记需要的段，fetch() 把相邻或间隔很小的区间
+// 合并成少量大读取，之后 payload() 返回指向读取结果的视图。
+// 元数据段通常紧挨在文件头部，对 RangedSource 一般只需一次请求；
+// 内存型数据源（映射文件/内存缓冲）直接返回源数据视图，不读取
+class SegmentLoader {
+public:
+  explicit SegmentLoader(ByteSource &src,
+                         const CoalesceOptions &opt = CoalesceOptions());
+
+  void want(const SegmentIndex &seg);
+  // 读取所有登记的区间；读取失败或数据不足的段在 payload() 时返回 false
+  void fetch();
+  // 视图在 SegmentLoader 销毁前有效；未登记的段返回 false
+  bool payload(const SegmentIndex &seg, ByteSpan &out) const;
+
+  size_t range_count() const { return ranges_.size(); }
+
+private:
+  struct Range {
+    uint64_t offset = 0;
+    uint64_t len = 0;
+    std::vector<uint8_t> data; // 实际读到的字节，可能短于 len
+  };
+
+  ByteSource &src_;
+  CoalesceOptions opt_;
+  ByteSpan all_; // 内存型数据源的整体视图
+  std::vector<std::pair<uint64_t, uint64_t>> wanted_; // [offset, end)
+  std::vector<Range> ranges_;                         // 按 offset 升序
+};
@@ -0,0 +1,145 @@
+// stats.cpp
+#include "stats.h"
+#include "json_writer.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+static const char *const kPhaseNames[] = {
+    "index",      "payload_load", "parse_jfif", "parse_sof",
+    "parse_exif", "parse_xmp",    "parse_icc",  "parse_adobe",
+    "parse_com",  "format",
+};
+static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) ==
+                  (size_t)Phase::Count,
+              "phase name table out of sync");
+
+const char *phase_name(Phase p) { return kPhaseNames[(size_t)p]; }
+
+void IoCounters::add(const IoCounters &o) {
+  read_calls += o.read_calls;
+  seek_calls += o.seek_calls;
+  bytes_read += o.bytes_read;
+  bytes_viewed += o.bytes_viewed;
+  range_requests += o.range_requests;
+}
+
+IoCounters IoCounters::since(const IoCounters &before) const {
+  IoCounters d;
+  d.read_calls = read_calls - before.read_calls;
+  d.seek_calls = seek_calls - before.seek_calls;
+  d.bytes_read = bytes_read - before.bytes_read;
+  d.bytes_viewed = bytes_viewed - before.bytes_viewed;
+  d.range_requests = range_requests - before.range_requests;
+  return d;
+}
+
+void FileStats::add(const FileStats &o) {
+  for (size_t i = 0; i < (size_t)Phase::Count; i++)
+    phase_ns[i] += o.phase_ns[i];
+  io.add(o.io);
+  allocations += o.allocations;
+  total_ns += o.total_ns;
+}
+
+void RunStats::add_file(const std::string &path, const FileStats &fs,
+                        bool ok) {
+  total_.add(fs);
+  latencies_.push_back({fs.total_ns, path});
+  if (!ok)
+    failed_++;
+}
+
+std::vector<RunStats::FileLatency> RunStats::sorted() const {
+  std::vector<FileLatency> v = latencies_;
+  std::sort(v.begin(), v.end(), [](const FileLatency &a, const FileLatency &b) {
+    return a.ns < b.ns;
+  });
+  return v;
+}
+
+// nearest-rank 百分位
+static uint64_t nearest_rank(const std::vector<uint64_t> &v, double p) {
+  if (v.empty())
+    return 0;
+  size_t rank = (size_t)std::ceil(p / 100.0 * (double)v.size());
+  return v[std::min(v.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static double to_ms(uint64_t ns) { return (double)ns / 1e6; }
+
+void RunStats::print_text(std::ostream &os) const {
+  auto lat = sorted();
+  std::vector<uint64_t> ns;
+  for (const auto &l : lat)
+    ns.push_back(l.ns);
+
+  os << "\n=== Stats ===\n";
+  os << std::fixed << std::setprecision(3);
+  os << "  Files: " << lat.size() << " (failed " << failed_ << ")\n";
+  os << "  Wall time: " << to_ms(wall_ns_) << " ms\n";
+  os << "  Phases (summed over files, ms):\n";
+  for (size_t i = 0; i < (size_t)Phase::Count; i++)
+    os << "    " << std::left << std::setw(14) << kPhaseNames[i] << std::right
+       << std::setw(12) << to_ms(total_.phase_ns[i]) << "\n";
+  os << "  I/O: " << total_.io.read_calls << " reads, " << total_.io.seek_calls
+     << " seeks, " << total_.io.bytes_read << " bytes read, "
+     << total_.io.bytes_viewed << " bytes viewed (zero-copy), "
+     << total_.io.range_requests << " range requests\n";
+  os << "  Allocations: " << total_.allocations << "\n";
+  if (!ns.empty()) {
+    os << "  Per-file latency (ms): p50=" << to_ms(nearest_rank(ns, 50))
+       << " p95=" << to_ms(nearest_rank(ns, 95))
+       << " p99=" << to_ms(nearest_rank(ns, 99))
+       << " max=" << to_ms(ns.back()) << "\n";
+    os << "  Slowest:\n";
+    for (size_t i = 0; i < std::min<size_t>(5, lat.size()); i++) {
+      const auto &l = lat[lat.size() - 1 - i];
+      os << "    " << std::setw(10) << to_ms(l.ns) << " ms  " << l.path << "\n";
+    }
+  }
+  os.unsetf(std::ios::fixed);
+}
+
+void RunStats::print_json(std::ostream &os) const {
+  auto lat = sorted();
+  std::vector<uint64_t> ns;
+  for (const auto &l : lat)
+    ns.push_back(l.ns);
+
+  std::string out;
+  JsonWriter w(out);
+  w.begin_object();
+  w.field("files", lat.size());
+  w.field("failed", failed_);
+  w.field("wall_ns", wall_ns_);
+  w.key("phases_ns").begin_object();
+  for (size_t i = 0; i < (size_t)Phase::Count; i++)
+    w.field(kPhaseNames[i], total_.phase_ns[i]);
+  w.end_object();
+  w.key("io").begin_object();
+  w.field("read_calls", total_.io.read_calls);
+  w.field("seek_calls", total_.io.seek_calls);
+  w.field("bytes_read", total_.io.bytes_read);
+  w.field("bytes_viewed", total_.io.bytes_viewed);
+  w.field("range_requests", total_.io.range_requests);
+  w.end_object();
+  w.field("allocations", total_.allocations);
+  w.key("latency_ns").begin_object();
+  w.field("p50", nearest_rank(ns, 50));
+  w.field("p95", nearest_rank(ns, 95));
+  w.field("p99", nearest_rank(ns, 99));
+  w.field("max", ns.empty() ? (uint64_t)0 : ns.back());
+  w.end_object();
+  w.key("slowest").begin_array();
+  for (size_t i = 0; i < std::min<size_t>(5, lat.size()); i++) {
+    const auto &l = lat[lat.size() - 1 - i];
+    w.begin_object();
+    w.field("path", std::string_view(l.path));
+    w.field("ns", l.ns);
+    w.end_object();
+  }
+  w.end_array();
+  w.end_object();
+  os << out << "\n";
+}
@@ -0,0 +1,95 @@
+// stats.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 分阶段计时项
+enum class Phase {
+  Index,
+  PayloadLoad,
+  ParseJfif,
+  ParseSof,
+  ParseExif,
+  ParseXmp,
+  ParseIcc,
+  ParseAdobe,
+  ParseCom,
+  Format,
+  Count,
+};
+
+const char *phase_name(Phase p);
+
+// 数据源 I/O 计数：read/seek 调用次数、实际读取（拷贝）的字节、
+// 以零拷贝视图访问的字节（内存/映射数据源）、按区间拉取的请求数（RangedSource）
+struct IoCounters {
+  uint64_t read_calls = 0;
+  uint64_t seek_calls = 0;
+  uint64_t bytes_read = 0;
+  uint64_t bytes_viewed = 0;
+  uint64_t range_requests = 0;
+
+  void add(const IoCounters &o);
+  IoCounters since(const IoCounters &before) const;
+};
+
+// 单个文件（或多个文件累加）的统计
+struct FileStats {
+  uint64_t phase_ns[(size_t)Phase::Count] = {};
+  IoCounters io;
+  uint64_t allocations = 0;
+  uint64_t total_ns = 0;
+
+  void add(const FileStats &o);
+};
+
+// RAII 计时：stats 为空时不计时
+class PhaseTimer {
+public:
+  PhaseTimer(FileStats *stats, Phase phase) : stats_(stats), phase_(phase) {
+    if (stats_)
+      t0_ = std::chrono::steady_clock::now();
+  }
+  ~PhaseTimer() {
+    if (stats_)
+      stats_->phase_ns[(size_t)phase_] += elapsed_ns(t0_);
+  }
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  static uint64_t elapsed_ns(std::chrono::steady_clock::time_point t0) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - t0)
+        .count();
+  }
+
+private:
+  FileStats *stats_;
+  Phase phase_;
+  std::chrono::steady_clock::time_point t0_;
+};
+
+// 一次运行（可能多文件）的汇总：总量 + 每文件延迟分布
+class RunStats {
+public:
+  void add_file(const std::string &path, const FileStats &fs, bool ok);
+  void set_wall_ns(uint64_t ns) { wall_ns_ = ns; }
+
+  void print_text(std::ostream &os) const;
+  void print_json(std::ostream &os) const;
+
+private:
+  struct FileLatency {
+    uint64_t ns;
+    std::string path;
+  };
+  std::vector<FileLatency> sorted() const;
+
+  FileStats total_;
+  std::vector<FileLatency> latencies_;
+  size_t failed_ = 0;
+  uint64_t wall_ns_ = 0;
+};
@@ -0,0 +1,35 @@
+// text_writer.cpp
+#include "text_writer.h"
+#include <algorithm>
+#include <cstdio>
+
+TextWriter &TextWriter::hex(uint64_t v, int width) {
+  char buf[24];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v, 16);
+  size_t n = (size_t)(res.ptr - buf);
+  for (size_t i = 0; i < n; i++)
+    if (buf[i] >= 'a')
+      buf[i] = (char)(buf[i] - 'a' + 'A');
+  if ((int)n < width)
+    out_.append((size_t)width - n, '0');
+  out_.append(buf, n);
+  return *this;
+}
+
+TextWriter &TextWriter::fixed(double v, int prec) {
+  // 浮点 to_chars 在部分标准库上尚未提供，退回 snprintf（同样不经过 iostream）
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  char buf[64];
+  auto res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed,
+                           prec);
+  if (res.ec == std::errc()) {
+    out_.append(buf, (size_t)(res.ptr - buf));
+    return *this;
+  }
+#endif
+  char sbuf[512]; // %f 对很大的数会展开全部整数位
+  int n = std::snprintf(sbuf, sizeof(sbuf), "%.*f", prec, v);
+  if (n > 0)
+    out_.append(sbuf, std::min<size_t>((size_t)n, sizeof(sbuf) - 1));
+  return *this;
+}
@@ -0,0 +1,82 @@
+// text_writer.h
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 追加式文本格式化：数字经 std::to_chars 写入栈上缓冲后追加到调用方的 std::string，
+// 不经过 iostream 与 locale，也不为每个值构造临时字符串。
+// 输出缓冲由调用方持有，clear() 后容量保留，可在多个文件之间复用
+class TextWriter {
+public:
+  explicit TextWriter(std::string &out) : out_(out) {}
+
+  std::string &str() { return out_; }
+
+  TextWriter &operator<<(std::string_view s) {
+    out_.append(s.data(), s.size());
+    return *this;
+  }
+  TextWriter &operator<<(const char *s) { return *this << std::string_view(s); }
+  TextWriter &operator<<(const std::string &s) {
+    return *this << std::string_view(s);
+  }
+  TextWriter &operator<<(char c) {
+    out_ += c;
+    return *this;
+  }
+  // 整数一律按十进制数值输出（uint8_t 也不当作字符）
+  template <class T, std::enable_if_t<std::is_integral_v<T> &&
+                                          !std::is_same_v<T, bool> &&
+                                          !std::is_same_v<T, char>,
+                                      int> = 0>
+  TextWriter &operator<<(T v) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, (size_t)(res.ptr - buf));
+    return *this;
+  }
+
+  // 大写十六进制，不含 "0x"；不足 width 位时补 0
+  TextWriter &hex(uint64_t v, int width = 0);
+  // 定点小数，等价于 std::fixed << std::setprecision(prec)
+  TextWriter &fixed(double v, int prec);
+
+  // 右对齐 / 左对齐到 width 列（等价于 std::setw，超长时不截断）
+  TextWriter &right(std::string_view s, size_t width) {
+    pad(s.size(), width);
+    return *this << s;
+  }
+  TextWriter &left(std::string_view s, size_t width) {
+    *this << s;
+    pad(s.size(), width);
+    return *this;
+  }
+  template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  TextWriter &right(T v, size_t width) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    return right(std::string_view(buf, (size_t)(res.ptr - buf)), width);
+  }
+  // 十进制补 0 到 width 位（如 JFIF 版本号的次版本）
+  template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  TextWriter &zero_pad(T v, size_t width) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    size_t n = (size_t)(res.ptr - buf);
+    if (n < width)
+      out_.append(width - n, '0');
+    out_.append(buf, n);
+    return *this;
+  }
+
+private:
+  void pad(size_t len, size_t width) {
+    if (len < width)
+      out_.append(width - len, ' ');
+  }
+
+  std::string &out_;
+};